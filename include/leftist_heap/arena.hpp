@@ -0,0 +1,94 @@
+#ifndef ARENA_HPP_INCLUDE_GUARD
+#define ARENA_HPP_INCLUDE_GUARD
+
+#include "macros.hpp"
+#include "chunks.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+// A scope-bound owner: nodes are bumped out of fixed-size chunks and are
+// never moved or freed one by one. Everything goes away at once when the
+// arena is reset or goes out of scope.
+//
+// reset() keeps the chunks around, so a build-drain-reset loop stops
+// calling malloc once the arena has warmed up.
+//
+// Like an obstack, it can also be rolled back to a mark(): release(m)
+// drops every node made after m, which is O(1) for trivially destructible
+// nodes. Heaps built after the mark dangle once it is released.
+template<class T, std::size_t ChunkSize = 1024>
+class arena {
+  chunk_list<T, ChunkSize> chunks_;
+  std::size_t              used_ = 0;
+
+ public:
+  arena() = default;
+  // mems point at their arena
+  arena(arena const&) = delete;
+  arena& operator=(arena const&) = delete;
+  ~arena() { reset(); }
+
+  struct mark_t {
+    std::size_t used;
+  };
+
+  // slots used, including any skipped by reserve
+  std::size_t size() const noexcept { return used_; }
+
+  T const* make(auto&&... args) {
+    if(HEDLEY_UNLIKELY(used_ == chunks_.capacity())) chunks_.add_chunk();
+    T* p = std::construct_at(chunks_.slot(used_), FWD(args)...);
+    ++used_;
+    return p;
+  }
+
+  // The next k nodes go next to each other: if they won't fit in what's
+  // left of this chunk, skip to the next one. Skipped slots are never
+  // constructed, so only trivially destructible nodes can skip.
+  void reserve(std::size_t k) noexcept {
+    // what's left of the chunk used_ is in, later chunks may be allocated
+    // already (after a release)
+    auto const left = (ChunkSize - used_ % ChunkSize) % ChunkSize;
+    if constexpr(std::is_trivially_destructible_v<T>)
+      if(left < k && k <= ChunkSize) used_ += left;
+  }
+
+  mark_t mark() const noexcept { return {used_}; }
+
+  void release(mark_t m) noexcept(LEFTIST_HEAP_ASSERT_NOEXCEPT) {
+    LEFTIST_HEAP_ASSERT(m.used <= used_);
+    if constexpr(!std::is_trivially_destructible_v<T>)
+      while(used_ > m.used) std::destroy_at(chunks_.slot(--used_));
+    used_ = m.used;
+  }
+
+  void reset() noexcept { release({0}); }
+};
+
+template<class T, std::size_t ChunkSize = 1024>
+struct arena_mem {
+  using Key = void const*;
+  // keys are pointers, any arena_mem can read them
+  static constexpr bool shared_keys = true;
+  arena<T, ChunkSize>* owner;
+
+  T const& operator[](Key i) const noexcept(LEFTIST_HEAP_ASSERT_NOEXCEPT) {
+    LEFTIST_HEAP_ASSERT(!is_null(i));
+    return *static_cast<T const*>(i);
+  }
+
+  constexpr Key  null() const noexcept { return nullptr; }
+  constexpr bool is_null(Key i) const noexcept { return i == nullptr; }
+
+  Key make_key(auto&&... args) NOEX(Key{owner->make(FWD(args)...)})
+
+  void reserve(std::size_t k) const noexcept { owner->reserve(k); }
+
+  auto mark() const NOEX(owner->mark())
+  void release(typename arena<T, ChunkSize>::mark_t m) const
+      NOEX(owner->release(m))
+};
+
+#endif // ARENA_HPP_INCLUDE_GUARD
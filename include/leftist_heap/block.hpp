@@ -0,0 +1,210 @@
+#ifndef BLOCK_HPP_INCLUDE_GUARD
+#define BLOCK_HPP_INCLUDE_GUARD
+
+#include "heap.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+// The hybrid heap from ideas.org: every node holds a sorted block of up to
+// B elements, all of them <= everything in the node's children. A leftist
+// tree of blocks has about B times fewer nodes to chase through.
+//
+// A key's low bits are an offset into its node's block, the first element
+// still in the heap. So peek is one load and pop is usually just key + 1,
+// no allocation. Popping or merging away part of a block is also just a
+// new offset, so merge only allocates the node for the merged block on
+// top, one per level of the right spine it walks down.
+//
+// Keys have to be unsigned integers, e.g. a vector_mem's indices. Unused
+// block slots hold T{}.
+template<class T,
+         class key     = std::uint32_t,
+         std::size_t B = 8,
+         class Rank    = std::uint8_t>
+class BlockNode {
+ public:
+  using element_t = T;
+  using Key       = key;
+
+  static constexpr std::size_t block_size = B;
+
+ private:
+  static_assert(std::is_unsigned_v<Key>);
+  static_assert(0 < B && B <= std::numeric_limits<std::uint8_t>::max());
+
+  static constexpr int shift       = std::bit_width(B - 1);
+  static constexpr Key offset_mask = (Key{1} << shift) - 1;
+
+  using block_t = std::array<T, B>;
+
+  // clang-format off
+  enum                    { elts_i, used_i      , left_i, right_i, rank_i };
+  size_sorted_tuple<block_t, std::uint8_t, Key   , Key    , Rank   > data_;
+  // clang-format on
+
+  constexpr block_t const& elts() const noexcept {
+    return data_.template get<elts_i>();
+  }
+  READER(used, data_.template get<used_i>())
+  READER(rank, data_.template get<rank_i>())
+
+  static constexpr Key index(Read<Key> k) noexcept { return k >> shift; }
+  static constexpr std::size_t offset(Read<Key> k) noexcept {
+    return k & offset_mask;
+  }
+  // the same node, starting from element i of its block
+  static constexpr Key at(Read<Key> k, std::size_t i) noexcept {
+    return (k & ~offset_mask) | static_cast<Key>(i);
+  }
+
+  static constexpr auto const& node(auto const mem, Read<Key> k)
+      NOEX(mem[index(k)])
+
+  constexpr static Rank rank_of(auto const mem, Read<Key> k)
+      NOEX(mem.is_null(k) ? Rank{} : node(mem, k).rank())
+
+  constexpr static bool is_leaf(auto const mem, Read<Key> k)
+      NOEX(!mem.is_null(k) && mem.is_null(node(mem, k).left())
+           && mem.is_null(node(mem, k).right()))
+
+  struct permission2construct {
+    friend BlockNode;
+
+   private:
+    permission2construct() = default;
+  };
+
+ public:
+  BlockNode() = default;
+  BlockNode(permission2construct,
+            block_t const& elts,
+            std::uint8_t   used,
+            Key            left,
+            Key            right,
+            Rank           rank)
+      : data_{elts, used, std::move(left), std::move(right), rank} {}
+
+  READER(left, data_.template get<left_i>())
+  READER(right, data_.template get<right_i>())
+
+  // a node for the first used elements of elts, which must be sorted
+  constexpr static Key make(auto           mem,
+                            block_t const& elts,
+                            std::size_t    used,
+                            Read<Key>      node1,
+                            Read<Key>      node2) {
+    LEFTIST_HEAP_ASSERT(0 < used && used <= B);
+    auto const& [r, l] =
+        std::minmax(node1, node2, cmp_by([=] FN(rank_of(mem, _))));
+    auto const k = mem.template make_key(
+        permission2construct{},
+        elts,
+        narrow<std::uint8_t>(used),
+        l,
+        r,
+        narrow<Rank>(rank_of(mem, r) + 1));
+    LEFTIST_HEAP_ASSERT(index(k << shift) == k);
+    return k << shift;
+  }
+
+  constexpr static Key make1(auto mem, T e) {
+    block_t elts{};
+    elts[0] = std::move(e);
+    return make(mem, elts, 1, mem.null(), mem.null());
+  }
+
+  constexpr static ReadReturn<T> peek(auto const mem, Read<Key> k)
+      NOEX(node(mem, k).elts()[offset(k)])
+
+  constexpr static Key pop(auto mem, auto less, Read<Key> k) {
+    auto const& n = node(mem, k);
+    return offset(k) + 1 < n.used()
+             ? k + 1
+             : merge(mem, less, n.left(), n.right());
+  }
+
+  // the usual count would count blocks, not elements
+  constexpr static std::size_t count(auto const mem, Read<Key> k) {
+    if(mem.is_null(k)) return 0;
+    auto const& n = node(mem, k);
+    return n.used() - offset(k) + count(mem, n.left())
+         + count(mem, n.right());
+  }
+
+  constexpr static Key
+      merge(auto mem, auto less, Read<Key> node1, Read<Key> node2) {
+    if(mem.is_null(node1)) return node2;
+    if(mem.is_null(node2)) return node1;
+    auto const  ka = node1, kb = node2;
+    auto const& a  = node(mem, ka);
+    auto const& b  = node(mem, kb);
+
+    // The merged block takes the least elements of both blocks, as long as
+    // they're <= every child. Whatever's left of a block is that node
+    // again at a later offset.
+    T const* bound = nullptr;
+    for(auto const child : {a.left(), a.right(), b.left(), b.right()})
+      if(!mem.is_null(child)
+         && (bound == nullptr || less(peek(mem, child), *bound)))
+        bound = &node(mem, child).elts()[offset(child)];
+
+    block_t     elts{};
+    std::size_t n = 0, i = offset(ka), j = offset(kb);
+    bool        last_from_a = true;
+    while(n < B && (i < a.used() || j < b.used())) {
+      last_from_a = j == b.used()
+                 || (i < a.used() && !less(b.elts()[j], a.elts()[i]));
+      auto const& x = last_from_a ? a.elts()[i] : b.elts()[j];
+      if(bound != nullptr && less(*bound, x)) break;
+      elts[n++] = x;
+      ++(last_from_a ? i : j);
+    }
+
+    // A used up block hands its children to the merged node. We can take
+    // one node's children in O(1), but both would need two more merges:
+    // give back the last element instead.
+    if(i == a.used() && j == b.used()) {
+      if(is_leaf(mem, ka))
+        return make(mem, elts, n, b.left(), b.right());
+      if(is_leaf(mem, kb))
+        return make(mem, elts, n, a.left(), a.right());
+      --n;
+      --(last_from_a ? i : j);
+    }
+    if(i < a.used() && j < b.used())
+      return make(mem, elts, n, at(ka, i), at(kb, j));
+
+    auto const  used_up = i == a.used() ? ka : kb;
+    auto const  rest    = i == a.used() ? at(kb, j) : at(ka, i);
+    auto const& r       = node(mem, rest);
+    auto const  left    = r.left();
+    auto const  right   = r.right();
+    // A short rest left on top of its children stays short. If there are
+    // no other children to merge, sink it into a new leaf instead, where
+    // later merges can fill it up.
+    if(auto const rest_size = r.used() - offset(rest);
+       is_leaf(mem, used_up) && !is_leaf(mem, rest) && 2 * rest_size < B) {
+      block_t sunk{};
+      std::copy(r.elts().begin() + static_cast<std::ptrdiff_t>(offset(rest)),
+                r.elts().begin() + r.used(),
+                sunk.begin());
+      auto const leaf = make(mem, sunk, rest_size, mem.null(), mem.null());
+      return make(mem, elts, n, left, merge(mem, less, right, leaf));
+    }
+    auto const used_left = node(mem, used_up).left();
+    // always merge with the right b/c of leftist property
+    return make(mem,
+                elts,
+                n,
+                used_left,
+                merge(mem, less, node(mem, used_up).right(), rest));
+  }
+};
+
+#endif // BLOCK_HPP_INCLUDE_GUARD
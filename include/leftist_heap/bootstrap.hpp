@@ -0,0 +1,101 @@
+#ifndef BOOTSTRAP_HPP_INCLUDE_GUARD
+#define BOOTSTRAP_HPP_INCLUDE_GUARD
+
+#include "heap.hpp"
+
+#include <optional>
+#include <type_traits>
+
+// An element of a BootstrappedHeap's inner heap: a minimum, and the heap
+// of everything that was merged under it.
+template<class T, class Key>
+struct boot_elt {
+  T   min;
+  Key rest; // the root of another inner heap, in the same mem
+};
+
+// Brodal and Okasaki's bootstrapping: a heap is its minimum plus a heap
+// of heaps. Merging two is consing the one with the bigger minimum into
+// the other's inner heap, and peek doesn't touch the inner heap at all.
+// So with an O(1) cons underneath, e.g. PairingNode's, merge, cons and
+// peek are all O(1). pop costs an inner pop and an inner merge.
+//
+// Node is the inner heap's node, for boot_elt<T, Node::Key> elements: e.g.
+// PairingNode<boot_elt<T, std::uint32_t>, std::uint32_t>.
+template<class T, class Less, class Mem, class Node>
+class BootstrappedHeap {
+  using Key = typename Node::Key;
+  using Elt = boot_elt<T, Key>;
+  static_assert(std::is_same_v<typename Node::element_t, Elt>);
+
+  struct less_min {
+    [[no_unique_address]] Less less;
+    constexpr bool operator()(Elt const& a, Elt const& b) const
+        NOEX(less(a.min, b.min))
+  };
+  using Inner = Heap<Elt, less_min, Mem, Node>;
+
+  [[no_unique_address]] Less        less_;
+  [[no_unique_address]] mutable Mem mem_;
+  std::optional<Elt>                top_;
+
+  constexpr BootstrappedHeap(Mem mem, Less less, std::optional<Elt> top)
+      : less_{std::move(less)}, mem_{std::move(mem)}, top_{std::move(top)} {}
+
+  constexpr Inner inner(Read<Key> k) const {
+    return Inner::adopt(mem_, k, less_min{less_});
+  }
+
+  constexpr std::size_t count(Read<Key> k) const {
+    if(mem_.is_null(k)) return 0;
+    auto const& n = mem_[k];
+    return 1 + count(n.elt().rest) + count(n.left()) + count(n.right());
+  }
+
+ public:
+  using size_type = std::size_t;
+  constexpr explicit BootstrappedHeap(Mem mem = {}, Less less = {})
+      : BootstrappedHeap(std::move(mem), std::move(less), std::nullopt) {}
+
+  READER(less)
+  READER(mem)
+
+  constexpr bool          empty() const noexcept { return !top_; }
+  constexpr ReadReturn<T> peek() const noexcept(noex_assert) {
+    LEFTIST_HEAP_ASSERT(!empty());
+    return top_->min;
+  }
+
+  // other has to live in the same mem
+  constexpr BootstrappedHeap merge(BootstrappedHeap const& other) const {
+    if(empty()) return other;
+    if(other.empty()) return *this;
+    auto const& [lo, hi] = less_(other.top_->min, top_->min)
+                             ? std::pair{&*other.top_, &*top_}
+                             : std::pair{&*top_, &*other.top_};
+    return {mem_, less_, Elt{lo->min, inner(lo->rest).cons(*hi).root()}};
+  }
+
+  constexpr BootstrappedHeap cons(T e) const {
+    return merge({mem_, less_, Elt{std::move(e), mem_.null()}});
+  }
+
+  // the least inner heap's minimum comes up, and its rest is merged with
+  // the other inner heaps
+  constexpr BootstrappedHeap pop() const {
+    LEFTIST_HEAP_ASSERT(!empty());
+    auto const rest = inner(top_->rest);
+    if(rest.empty()) return {mem_, less_, std::nullopt};
+    Elt const next = rest.peek();
+    return {mem_,
+            less_,
+            Elt{next.min, inner(next.rest).merge(rest.pop()).root()}};
+  }
+
+  // O(n)
+  constexpr size_type size() const {
+    return empty() ? 0 : 1 + count(top_->rest);
+  }
+};
+
+#endif // BOOTSTRAP_HPP_INCLUDE_GUARD
@@ -0,0 +1,61 @@
+#ifndef CHUNKS_HPP_INCLUDE_GUARD
+#define CHUNKS_HPP_INCLUDE_GUARD
+
+#include "macros.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Uninitialized slots carved out of fixed-size chunks.
+// Chunks are never reallocated, so a slot's address is stable for the
+// lifetime of the list. Constructing and destroying the slots is the
+// owner's job.
+template<class T, std::size_t ChunkSize>
+class chunk_list {
+  static_assert(ChunkSize > 0);
+
+  struct chunk_deleter {
+    void operator()(T* p) const noexcept {
+      std::allocator<T>{}.deallocate(p, ChunkSize);
+    }
+  };
+  using chunk = std::unique_ptr<T, chunk_deleter>;
+
+  std::vector<chunk> chunks_;
+
+ public:
+  static constexpr std::size_t chunk_size = ChunkSize;
+
+  std::size_t chunk_count() const noexcept { return chunks_.size(); }
+  std::size_t capacity() const noexcept {
+    return chunks_.size() * ChunkSize;
+  }
+
+  T* add_chunk() {
+    // owned before the push_back, which may throw
+    chunk c{std::allocator<T>{}.allocate(ChunkSize)};
+    chunks_.push_back(std::move(c));
+    return chunks_.back().get();
+  }
+
+  // drops every chunk past the first n
+  void shrink(std::size_t n) noexcept {
+    if(n < chunks_.size())
+      chunks_.erase(chunks_.begin() + static_cast<std::ptrdiff_t>(n),
+                    chunks_.end());
+  }
+
+  T* chunk_data(std::size_t c) const
+      noexcept(LEFTIST_HEAP_ASSERT_NOEXCEPT) {
+    LEFTIST_HEAP_ASSERT(c < chunks_.size());
+    return chunks_[c].get();
+  }
+
+  T* slot(std::size_t i) const noexcept(LEFTIST_HEAP_ASSERT_NOEXCEPT) {
+    return chunk_data(i / ChunkSize) + i % ChunkSize;
+  }
+};
+
+#endif // CHUNKS_HPP_INCLUDE_GUARD
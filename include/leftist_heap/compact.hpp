@@ -0,0 +1,111 @@
+#ifndef COMPACT_HPP_INCLUDE_GUARD
+#define COMPACT_HPP_INCLUDE_GUARD
+
+#include "heap.hpp"
+
+#include <ranges>
+#include <span>
+#include <deque>
+#include <vector>
+
+// vector_mem never frees anything: every pop and cons leaves its dead path
+// copies in the block. A compacting copy is the collector for it.
+//
+// After many merges a node's children are scattered across the block, so
+// the copy also picks the order the nodes are laid out in:
+enum class layout {
+  // preorder, left child first: every left spine is contiguous
+  left_spine,
+  // preorder, right child first: every right spine is contiguous, which
+  // is the only path merge (and so pop and cons) ever walks
+  right_spine,
+  // level order: the top of the tree is packed into the first few cache
+  // lines, like the top levels of a van Emde Boas layout
+  breadth_first,
+};
+
+// Copies the nodes reachable from roots into `to`. Nodes shared between
+// roots are copied once. Returns the new keys of the roots, in order.
+template<class Node, class vector, class Key>
+std::vector<Key> compact(vector_mem<Node, vector, Key> from,
+                         vector_mem<Node, vector, Key> to,
+                         std::span<Key const> const    roots,
+                         layout const order_by = layout::left_spine) {
+  LEFTIST_HEAP_ASSERT(from.block != to.block);
+  // 0 is both null and "not copied yet"
+  std::vector<Key> remap(from.block->size() + 1, to.null());
+  std::vector<Key> order;
+  std::deque<Key>  todo;
+  for(auto const r : roots)
+    if(order_by == layout::breadth_first) todo.push_back(r);
+    else todo.push_front(r);
+
+  auto const base = to.block->size();
+  while(!todo.empty()) {
+    Key k;
+    if(order_by == layout::breadth_first) {
+      k = todo.front();
+      todo.pop_front();
+    } else {
+      k = todo.back();
+      todo.pop_back();
+    }
+    if(from.is_null(k) || !to.is_null(remap[k])) continue;
+    order.push_back(k);
+    remap[k] = narrow<Key>(base + order.size());
+    // as a stack, the child pushed last is copied next
+    switch(order_by) {
+      case layout::left_spine:
+        todo.push_back(from[k].right());
+        todo.push_back(from[k].left());
+        break;
+      case layout::right_spine:
+      case layout::breadth_first:
+        todo.push_back(from[k].left());
+        todo.push_back(from[k].right());
+        break;
+    }
+  }
+
+  to.block->reserve(base + order.size());
+  for(auto const k : order) {
+    auto const& n = from[k];
+    [[maybe_unused]] auto const copy =
+        Node::relink(to, n, remap[n.left()], remap[n.right()]);
+    LEFTIST_HEAP_ASSERT(copy == remap[k]);
+  }
+
+  std::vector<Key> new_roots;
+  new_roots.reserve(roots.size());
+  for(auto const r : roots) new_roots.push_back(remap[r]);
+  return new_roots;
+}
+
+// Copies heaps that share one vector_mem into the fresh block `to`.
+template<std::ranges::random_access_range Heaps,
+         class Heap = std::ranges::range_value_t<Heaps>>
+std::vector<Heap> compact(Heaps const&  heaps,
+                          auto*         to,
+                          layout const order_by = layout::left_spine) {
+  if(std::ranges::empty(heaps)) return {};
+  auto const mem = heaps.front().mem();
+  using Key      = std::decay_t<decltype(heaps.front().root())>;
+
+  std::vector<Key> roots;
+  for(auto const& h : heaps) {
+    LEFTIST_HEAP_ASSERT(h.mem().block == mem.block);
+    roots.push_back(h.root());
+  }
+  auto new_mem  = mem;
+  new_mem.block = to;
+  auto const new_roots =
+      compact(mem, new_mem, std::span<Key const>{roots}, order_by);
+
+  std::vector<Heap> out;
+  out.reserve(new_roots.size());
+  for(std::size_t i = 0; i < new_roots.size(); ++i)
+    out.push_back(Heap::adopt(new_mem, new_roots[i], heaps[i].less()));
+  return out;
+}
+
+#endif // COMPACT_HPP_INCLUDE_GUARD
@@ -0,0 +1,195 @@
+#ifndef GC_HPP_INCLUDE_GUARD
+#define GC_HPP_INCLUDE_GUARD
+
+#include "heap.hpp"
+#include "chunks.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+template<class Key>
+class root_list;
+
+// A Key that stays registered in a root_list while it lives.
+// Heaps over a tracing mem hold their root_ as one of these.
+template<class Key>
+class gc_root {
+  friend root_list<Key>;
+
+  Key              key_{};
+  mutable gc_root* prev_ = nullptr;
+  mutable gc_root* next_ = nullptr;
+
+  void link_after(gc_root const* at) noexcept {
+    if(at == nullptr) return;
+    prev_ = const_cast<gc_root*>(at);
+    next_ = at->next_;
+    if(next_ != nullptr) next_->prev_ = this;
+    at->next_ = this;
+  }
+  void unlink() noexcept {
+    if(prev_ != nullptr) prev_->next_ = next_;
+    if(next_ != nullptr) next_->prev_ = prev_;
+    prev_ = next_ = nullptr;
+  }
+  bool linked() const noexcept { return prev_ != nullptr; }
+
+ public:
+  gc_root() = default;
+  // an unregistered root, for mems without a collector
+  explicit gc_root(Key key) noexcept : key_{key} {}
+  gc_root(root_list<Key>* roots, Key key) noexcept : key_{key} {
+    if(roots != nullptr) link_after(&roots->head_);
+  }
+  gc_root(gc_root const& other) noexcept : key_{other.key_} {
+    if(other.linked()) link_after(&other);
+  }
+  gc_root& operator=(gc_root const& other) noexcept {
+    if(this == &other) return *this;
+    unlink();
+    key_ = other.key_;
+    if(other.linked()) link_after(&other);
+    return *this;
+  }
+  ~gc_root() { unlink(); }
+
+  operator Key const&() const noexcept { return key_; }
+};
+
+template<class Key>
+class root_list {
+  friend gc_root<Key>;
+  gc_root<Key> head_;
+
+ public:
+  root_list() = default;
+  root_list(root_list const&) = delete;
+  ~root_list() {
+    while(head_.next_ != nullptr) head_.next_->unlink();
+  }
+
+  // f(Key&): collectors that move nodes rewrite the roots in place
+  void for_each(auto f) {
+    for(auto r = head_.next_; r != nullptr; r = r->next_) f(r->key_);
+  }
+};
+
+// A tracing alternative to refcounting: keys are plain indices, Heaps
+// register their roots, and collect() marks everything reachable through
+// left()/right() and puts the rest on a free list for make_key to reuse.
+//
+// Only collect between operations: the nodes a merge is still building
+// aren't rooted anywhere.
+template<class T,
+         class Index           = std::uint32_t,
+         std::size_t ChunkSize = 1024>
+class gc_space {
+  enum class state : std::uint8_t { dead, live, marked };
+
+  chunk_list<T, ChunkSize> slots_;
+  std::vector<state>       state_;
+  std::vector<Index>       free_;
+  root_list<Index>         roots_;
+
+  // 1-based, like the keys
+  T* slot(Index i) const noexcept(LEFTIST_HEAP_ASSERT_NOEXCEPT) {
+    LEFTIST_HEAP_ASSERT(0 < i && i <= state_.size());
+    return slots_.slot(i - std::size_t{1});
+  }
+
+ public:
+  gc_space() = default;
+  gc_space(gc_space const&) = delete;
+  ~gc_space() {
+    if constexpr(!std::is_trivially_destructible_v<T>)
+      for(std::size_t i = 0; i < state_.size(); ++i)
+        if(state_[i] != state::dead) std::destroy_at(slots_.slot(i));
+  }
+
+  root_list<Index>* roots() noexcept { return &roots_; }
+
+  T const& operator[](Index i) const NOEX(*slot(i))
+
+  // slots in use or on the free list
+  std::size_t capacity() const noexcept { return state_.size(); }
+  std::size_t live() const noexcept { return capacity() - free_.size(); }
+
+  Index make(auto&&... args) {
+    if(!free_.empty()) {
+      auto const i = free_.back();
+      std::construct_at(slot(i), FWD(args)...);
+      free_.pop_back();
+      state_[i - std::size_t{1}] = state::live;
+      return i;
+    }
+    if(state_.size() == slots_.capacity()) slots_.add_chunk();
+    state_.push_back(state::live);
+    try {
+      std::construct_at(slots_.slot(state_.size() - 1), FWD(args)...);
+    } catch(...) {
+      state_.pop_back();
+      throw;
+    }
+    return narrow<Index>(state_.size());
+  }
+
+  // returns the number of nodes freed
+  std::size_t collect() {
+    std::vector<Index> todo;
+    roots_.for_each([&](Index r) { todo.push_back(r); });
+    while(!todo.empty()) {
+      auto const i = todo.back();
+      todo.pop_back();
+      if(i == 0) continue;
+      auto& s = state_[i - std::size_t{1}];
+      if(s == state::marked) continue;
+      s = state::marked;
+      todo.push_back((*this)[i].left());
+      todo.push_back((*this)[i].right());
+    }
+
+    std::size_t freed = 0;
+    for(std::size_t j = 0; j < state_.size(); ++j) {
+      switch(state_[j]) {
+        case state::marked: state_[j] = state::live; break;
+        case state::live:
+          std::destroy_at(slots_.slot(j));
+          state_[j] = state::dead;
+          free_.push_back(narrow<Index>(j + 1));
+          ++freed;
+          break;
+        case state::dead: break;
+      }
+    }
+    return freed;
+  }
+};
+
+template<class T,
+         class Index           = std::uint32_t,
+         std::size_t ChunkSize = 1024>
+struct gc_mem {
+  using Key  = Index;
+  using Root = gc_root<Key>;
+  gc_space<T, Index, ChunkSize>* space;
+
+  T const& operator[](Key i) const noexcept(LEFTIST_HEAP_ASSERT_NOEXCEPT) {
+    LEFTIST_HEAP_ASSERT(!is_null(i));
+    return (*space)[i];
+  }
+
+  constexpr Key  null() const noexcept { return 0; }
+  constexpr bool is_null(Key i) const noexcept { return i == 0; }
+
+  Key make_key(auto&&... args) NOEX(space->make(FWD(args)...))
+
+  Root root(Key k) const noexcept {
+    return space ? Root{space->roots(), k} : Root{k};
+  }
+  std::size_t collect() const { return space->collect(); }
+};
+
+#endif // GC_HPP_INCLUDE_GUARD
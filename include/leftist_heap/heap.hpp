@@ -5,14 +5,22 @@
 #include "read.hpp"
 #include "macros.hpp"
 #include "accessors.hpp"
+#include "sort_tuple.hpp"
+#include "runs.hpp"
 
+#include <array>
 #include <numeric>
 #include <memory>
 #include <algorithm>
 #include <ranges>
+#include <concepts>
 #include <limits>
 #include <cstdint>
-//#include <execution> //tbb is giving me linker errors
+#include <vector>
+#include <iterator>
+#include <exception>
+#include <thread>
+#include <span>
 
 static constexpr bool noex_assert = LEFTIST_HEAP_ASSERT_NOEXCEPT;
 
@@ -48,12 +56,31 @@ struct vector_mem {
   constexpr bool is_null(Read<Key> i) const noexcept { return i == 0; }
 
   constexpr Key make_key(auto&&... args)
-      NOEX(block->emplace_back(FWD(args)...), block->size())
+      NOEX(block->emplace_back(FWD(args)...),
+           narrow<Key>(block->size()))
+
+  // Nodes made after epoch() belong to whoever asked for the epoch, as
+  // long as nobody else makes nodes in this block meanwhile.
+  constexpr Key  epoch() const NOEX(narrow<Key>(block->size()))
+  constexpr bool is_unique(Read<Key> i, Key epoch) const noexcept {
+    return i > epoch;
+  }
+  // builds the new node before overwriting the old one, which args may
+  // point into
+  constexpr void overwrite(Key i, auto&&... args) {
+    (*block)[i - 1] = T(FWD(args)...);
+  }
 };
 
+// for mems that can tell whether a node is shared any time
+struct no_epoch {};
+
 template<class T>
 struct shared_ptr_mem {
   using Key = std::shared_ptr<void>;
+  // each thread fills its own node_runs
+  static constexpr bool thread_safe = true;
+  static constexpr bool shared_keys = true;
 
   // NOEX-ing this crashed clangd and clang-tidy?
   T const& operator[](Key const& i) const noexcept(noex_assert) {
@@ -63,10 +90,115 @@ struct shared_ptr_mem {
 
   Key  null() const { return {}; }
   bool is_null(Key const& x) const NOEX(x == nullptr)
-  auto make_key(auto&&... args)
-      ARROW(Key{std::make_shared<T>(FWD(args)...)})
+
+  // The next k nodes this thread makes share one allocation (see
+  // node_run), until the returned scope ends. A batch can't be one
+  // shared_ptr: the nodes point at each other, so it would own itself.
+  run_scope<T> reserve(std::size_t k) const {
+    if(k <= 1 || alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+      return run_scope<T>{nullptr};
+    auto& cache = run_cache<T>::local();
+    cache.start(k);
+    return run_scope<T>{&cache};
+  }
+
+  no_epoch epoch() const noexcept { return {}; }
+  bool is_unique(Key const& x, no_epoch) const noexcept {
+    return x.use_count() == 1;
+  }
+  // as in vector_mem, the new node's built first
+  void overwrite(Key const& x, auto&&... args) const {
+    *static_cast<T*>(x.get()) = T(FWD(args)...);
+  }
+
+  Key make_key(auto&&... args) {
+    auto& cache = run_cache<T>::local();
+    if(!cache.active()) return std::make_shared<T>(FWD(args)...);
+    Key k = std::allocate_shared<T>(run_allocator<T>{cache.run()},
+                                    FWD(args)...);
+    cache.took();
+    return k;
+  }
+};
+
+// Mems whose make_key any number of threads may call at once say
+// thread_safe = true.
+template<class Mem>
+concept thread_safe_mem = Mem::thread_safe;
+
+// Mems whose keys mean the same to every mem of the type say shared_keys
+// = true, e.g. pointers: a heap can have nodes that several of them made.
+template<class Mem>
+concept shared_keys_mem = Mem::shared_keys;
+
+// Mems that can make a run of nodes together, e.g. next to each other or
+// with one allocation, have a reserve(k): the next k make_keys are a run.
+// reserve may return a scope that ends the run, keep it until they're
+// made.
+struct no_reservation {};
+[[nodiscard]] constexpr auto reserve_keys(auto const mem, std::size_t k) {
+  if constexpr(!requires { mem.reserve(k); }) return no_reservation{};
+  else if constexpr(std::is_void_v<decltype(mem.reserve(k))>) {
+    mem.reserve(k);
+    return no_reservation{};
+  } else {
+    return mem.reserve(k);
+  }
+}
+
+// A key on a merge's path. Keys that are expensive to copy (shared_ptrs)
+// are pointed at instead, they live in nodes that outlive the merge.
+template<class Key>
+class key_ref {
+  static constexpr bool by_value = !std::is_reference_v<Read<Key>>;
+  std::conditional_t<by_value, Key, Key const*> k_;
+
+ public:
+  key_ref() = default;
+  constexpr key_ref(Read<Key> k) noexcept {
+    if constexpr(by_value) k_ = k;
+    else k_ = &k;
+  }
+  constexpr Read<Key> get() const noexcept {
+    if constexpr(by_value) return k_;
+    else return *k_;
+  }
+};
+
+// Keys that own their node, like shared_ptr_mem's: dropping the last one
+// destroys the node, which drops its own keys in turn.
+template<class Key>
+concept owning_key = requires(Key const& k) {
+  { k.use_count() } -> std::convertible_to<long>;
 };
 
+// For the destructor of a node whose keys can make an O(n) chain (a
+// pairing heap's sibling list): dropping them recursively would blow the
+// stack. The keys nobody else holds go on a pending list, and the
+// outermost of these destructors on the thread drops them one at a time,
+// as rc_slab::release does.
+template<owning_key Key, std::same_as<Key>... Keys>
+void drop_keys(Key& key, Keys&... keys) noexcept {
+  thread_local std::vector<Key> pending;
+  thread_local bool             draining = false;
+  for(Key* const k : {&key, &keys...}) {
+    if(k->use_count() != 1) continue;
+    try {
+      pending.push_back(std::move(*k));
+    } catch(...) {
+      // then *k goes the recursive way
+    }
+  }
+  if(draining) return;
+  draining = true;
+  while(!pending.empty()) {
+    // destroying it may add to pending
+    auto const k = std::move(pending.back());
+    pending.pop_back();
+  }
+  draining = false;
+}
+
 // TODO: what is the right semantics for const, thread safety, and mems?
 
 
@@ -83,19 +215,24 @@ class Node {
   using Key       = key;
 
  private:
-  T    elt_;
-  Key  left_;
-  Key  right_;
-  Rank rank_; // should we store rank-1 instead? Might increase range but
-              // complicates logic
+  // Fields in whatever order packs tightest, e.g. a Node<char, uint32_t>
+  // is 12 bytes instead of 16.
+  // rank: should we store rank-1 instead? Might increase range but
+  // complicates logic
   // rank <= floor(log(n+1))
   // Okasaki, Purely functional data structures Exercise 3.1
   // if key=uint64
   // max # is #uint64s - 1 (-1 for null) = uint64max = 2^64-1
   // so rank <= 64, within uint8_t
+  // clang-format off
+  enum                    { elt_i, left_i, right_i, rank_i };
+  size_sorted_tuple<T    , Key   , Key    , Rank   > data_;
+  // clang-format on
+
+  READER(rank, data_.template get<rank_i>())
 
   constexpr static Rank rank_of(auto const mem, Read<Key> n)
-      NOEX(mem.is_null(n) ? Rank{} : mem[n].rank_)
+      NOEX(mem.is_null(n) ? Rank{} : mem[n].rank())
 
   struct permission2construct {
     friend Node;
@@ -108,11 +245,14 @@ class Node {
   // TODO: aggregate vs private
   Node() = default;
   Node(permission2construct, T elt, Key left, Key right, Rank rank)
-      : elt_{elt}, left_{left}, right_{right}, rank_{rank} {}
+      : data_{std::move(elt),
+              std::move(left),
+              std::move(right),
+              rank} {}
 
-  READER(elt)
-  READER(left)
-  READER(right)
+  READER(elt, data_.template get<elt_i>())
+  READER(left, data_.template get<left_i>())
+  READER(right, data_.template get<right_i>())
 
   constexpr static Key
       make(auto mem, T e, Read<Key> node1, Read<Key> node2) noexcept(
@@ -132,26 +272,89 @@ class Node {
   }
 
   constexpr static auto make1(auto mem, auto e)
-      ARROW(make(mem, e, mem.null(), mem.null()))
+      ARROW(make(mem, std::move(e), mem.null(), mem.null()))
+
+  // a copy of n in mem whose children are left and right
+  // (for collectors: left and right must be copies of n's children)
+  constexpr static Key
+      relink(auto mem, Node const& n, Read<Key> left, Read<Key> right)
+          NOEX(mem.template make_key(
+              permission2construct{}, n.elt(), left, right, n.rank()))
 
+  // Walks down both right spines, then makes the new spine bottom up.
+  // always merge with the right b/c of leftist property
   constexpr static Key
       merge(auto mem, auto less, Read<Key> node1, Read<Key> node2) noexcept(
           noexcept(mem.is_null(node1),
                    less(mem[node2].elt(), mem[node1].elt()),
                    make(mem, mem[node1].elt(), node1, node2))) {
-    return mem.is_null(node1) ? node2
-         : mem.is_null(node2) ? node1
-         : less(mem[node2].elt(),
-                mem[node1].elt()) // TODO: what to do for ties?
-             ? make(mem,
-                    mem[node2].elt(),
-                    mem[node2].left(),
-                    merge(mem, less, node1, mem[node2].right()))
-             : make(mem,
-                    mem[node1].elt(),
-                    mem[node1].left(),
-                    merge(mem, less, node2, mem[node1].right()));
-    // always merge with the right b/c of leftist property
+    return merge(
+        mem, less, node1, node2, [](Read<Key>) { return false; }, false, false);
+  }
+
+  // merge, but nodes that owned(key) says nobody else can see are edited
+  // in place instead of copied (see Heap::transient). That has to hold
+  // all the way down from a root: own1 and own2 say whether the caller
+  // owns its references to node1 and node2.
+  constexpr static Key merge(auto       mem,
+                             auto       less,
+                             Read<Key>  node1,
+                             Read<Key>  node2,
+                             auto const owned,
+                             bool       own1,
+                             bool       own2) {
+    // The path is at most rank(node1) + rank(node2) long, and a rank is
+    // at most log(n+1).
+    struct step {
+      key_ref<Key> node;
+      bool         owned;
+    };
+    std::array<step, 2 * std::numeric_limits<std::uintptr_t>::digits> path;
+    std::size_t depth = 0, copies = 0;
+
+    key_ref<Key> a = node1, b = node2;
+    bool own_a = own1 && owned(node1), own_b = own2 && owned(node2);
+    while(!mem.is_null(a.get()) && !mem.is_null(b.get())) {
+      // TODO: what to do for ties?
+      if(!less(mem[b.get()].elt(), mem[a.get()].elt())) {
+        std::swap(a, b);
+        std::swap(own_a, own_b);
+      }
+      LEFTIST_HEAP_ASSERT(depth < path.size());
+      path[depth++] = {b, own_b};
+      copies += !own_b;
+      b     = mem[b.get()].right();
+      own_b = own_b && owned(b.get());
+    }
+
+    Key merged = mem.is_null(a.get()) ? b.get() : a.get();
+    [[maybe_unused]] auto const reserved = reserve_keys(mem, copies);
+    while(depth > 0) {
+      auto const& [k, own] = path[--depth];
+      auto const& n        = mem[k.get()];
+      if constexpr(requires { mem.epoch(); })
+        if(own) {
+          merged = remake(mem, k.get(), n.elt(), n.left(), merged);
+          continue;
+        }
+      merged = make(mem, n.elt(), n.left(), merged);
+    }
+    return merged;
+  }
+
+ private:
+  // make, but overwriting node k
+  constexpr static Key
+      remake(auto mem, Read<Key> k, T e, Read<Key> node1, Read<Key> node2) {
+    auto const& [r, l] =
+        std::minmax(node1, node2, cmp_by([=] FN(rank_of(mem, _))));
+    mem.overwrite(k,
+                  permission2construct{},
+                  std::move(e),
+                  l,
+                  r,
+                  narrow<Rank>(rank_of(mem, r) + 1));
+    return k;
   }
 };
 
@@ -162,10 +365,12 @@ class WeightNode {
   using Key       = key;
 
  private:
-  T      elt_;
-  Key    left_;
-  Key    right_;
-  Weight weight_;
+  // clang-format off
+  enum                    { elt_i, left_i, right_i, weight_i };
+  size_sorted_tuple<T    , Key   , Key    , Weight   > data_;
+  // clang-format on
+
+  READER(weight, data_.template get<weight_i>())
 
   struct permission2construct {
     friend WeightNode;
@@ -175,7 +380,7 @@ class WeightNode {
   };
 
   constexpr static Weight weight_of(auto const mem, Read<Key> n)
-      NOEX(mem.is_null(n) ? Weight{} : mem[n].weight)
+      NOEX(mem.is_null(n) ? Weight{} : mem[n].weight())
 
   constexpr static Key
       make_ug(auto mem, T e, Read<Key> l, Read<Key> r, Weight w) NOEX(
@@ -184,54 +389,102 @@ class WeightNode {
  public:
   WeightNode() = default;
   WeightNode(permission2construct, T elt, Key left, Key right, Weight weight)
-      : elt_{elt}, left_{left}, right_{right}, weight_{weight} {}
-
-  READER(elt)
-  READER(left)
-  READER(right)
+      : data_{std::move(elt),
+              std::move(left),
+              std::move(right),
+              weight} {}
 
-  constexpr static auto make1(auto mem, auto e) ARROW(mem.template make_key(
-      permission2construct{},
-      e,
-      mem.null(),
-      mem.null(),
-      1))
-
-  // TODO: local copy the node, or all the node but the element, to hint to
-  // the compiler it won't change?
-  constexpr static Key
-      merge(auto mem, auto less, Read<Key> node1, Read<Key> node2) noexcept(
-          noexcept(mem.is_null(node1),
-                   less(mem[node2].elt(), mem[node1].elt()),
-                   make(mem, mem[node1].elt(), node1, node2))) {
-    if(mem.is_null(node1)) return node2;
-    if(mem.is_null(node2)) return node1;
-
-    auto const w = weight_of(mem, node1) + weight_of(mem, node2);
-    auto const& [small, big] =
-        std::minmax(node1, node2, cmp_by([=] FN(_.elt()), less));
-    auto const  mixed = merge(mem, less, mem[small].right, mem[big]);
-    auto const& same  = mem[small].left;
-    auto const  mixed_weight =
-        weight_of(mem, mem[small].right) + weight_of(mem, big);
-    auto const same_weight = weight_of(mem, same);
+  READER(elt, data_.template get<elt_i>())
+  READER(left, data_.template get<left_i>())
+  READER(right, data_.template get<right_i>())
 
+  constexpr static Key make(auto mem, T e, Read<Key> node1, Read<Key> node2)
+      noexcept(noexcept(weight_of(mem, node1), mem.make_key(node1))) {
     auto const& [light, heavy] =
-        (same_weight < mixed_weight)
-            ? std::pair{same, mixed}
-            : std::pair{mixed, same};
+        std::minmax(node1, node2, cmp_by([=] FN(weight_of(mem, _))));
     return make_ug(mem,
-                   less,
-                   mem[small].elt,
-                   light,
+                   std::move(e),
                    heavy,
-                   mixed_weight + same_weight + 1);
+                   light,
+                   weight_of(mem, light) + weight_of(mem, heavy) + 1);
   }
 
-  constexpr static auto count(auto const mem, Read<Key> node)
-      ARROW(weight_of(mem, node))
+  constexpr static auto make1(auto mem, T e)
+      ARROW(make_ug(mem, std::move(e), mem.null(), mem.null(), 1))
+
+  constexpr static Key
+      relink(auto mem, WeightNode const& n, Read<Key> left, Read<Key> right)
+          NOEX(make_ug(mem, n.elt(), left, right, n.weight()))
+
+  // Weight-biased heaps can merge top down in one pass: the weight of
+  // what's merged is known before it's merged, so which side it goes on
+  // is too. Nodes are immutable, so that pass just writes the decisions
+  // down and the nodes are made on the way back up, without recursion.
+  constexpr static Key
+      merge(auto mem, auto less, Read<Key> node1, Read<Key> node2) {
+    struct step {
+      key_ref<Key> small;
+      key_ref<Key> same; // small's child that isn't merged
+      bool         same_left;
+      Weight       weight;
+    };
+    // The right spine of a weight-biased tree of weight w is at most
+    // log(w+1) long, and merge walks down the two right spines.
+    std::array<step, 2 * std::numeric_limits<Weight>::digits> path;
+    std::size_t depth = 0;
+
+    key_ref<Key> a = node1, b = node2;
+    while(!mem.is_null(a.get()) && !mem.is_null(b.get())) {
+      if(less(mem[b.get()].elt(), mem[a.get()].elt())) std::swap(a, b);
+      auto const& n           = mem[a.get()];
+      auto const  same_weight = weight_of(mem, n.left());
+      auto const  mixed_weight =
+          weight_of(mem, n.right()) + weight_of(mem, b.get());
+      LEFTIST_HEAP_ASSERT(depth < path.size());
+      path[depth++] = {a,
+                       n.left(),
+                       !(same_weight < mixed_weight),
+                       same_weight + mixed_weight + 1};
+      a = n.right();
+    }
+
+    Key merged = mem.is_null(a.get()) ? b.get() : a.get();
+    [[maybe_unused]] auto const reserved = reserve_keys(mem, depth);
+    while(depth > 0) {
+      auto const& s = path[--depth];
+      merged        = s.same_left ? make_ug(mem,
+                                     mem[s.small.get()].elt(),
+                                     s.same.get(),
+                                     merged,
+                                     s.weight)
+                                  : make_ug(mem,
+                                     mem[s.small.get()].elt(),
+                                     merged,
+                                     s.same.get(),
+                                     s.weight);
+    }
+    return merged;
+  }
+
+  constexpr static Weight count(auto const mem, Read<Key> node)
+      NOEX(weight_of(mem, node))
 };
 
+// no padding but at the end
+static_assert(sizeof(Node<char, std::uint32_t>)
+              == tight_size<char, std::uint32_t, std::uint32_t, std::uint8_t>);
+static_assert(sizeof(Node<char, std::uint32_t>) == 12);
+static_assert(sizeof(Node<int, std::uint64_t>)
+              == tight_size<int, std::uint64_t, std::uint64_t, std::uint8_t>);
+static_assert(sizeof(Node<double, void const*>)
+              == tight_size<double, void const*, void const*, std::uint8_t>);
+static_assert(sizeof(WeightNode<char, std::uint32_t, std::uint32_t>)
+              == tight_size<char,
+                            std::uint32_t,
+                            std::uint32_t,
+                            std::uint32_t>);
+static_assert(std::is_trivially_copyable_v<Node<int, std::uint64_t>>);
+
 template<class Node_>
 struct NodeUtil {
   using Node = Node_;
@@ -243,27 +496,55 @@ struct NodeUtil {
   constexpr static Key pop(auto mem, auto less, Read<Key> k)
       NOEX(Node::merge(mem, less, mem[k].left(), mem[k].right()))
 
+  // Nodes that hold more than one element (see BlockNode) peek and pop
+  // themselves.
+  template<class Mem>
+  requires requires(Mem mem, Key k) { Node::peek(mem, k); }
+  constexpr static ReadReturn<T> peek(Mem const mem, Read<Key> k)
+      NOEX(Node::peek(mem, k))
+  template<class Mem, class Less>
+  requires requires(Mem mem, Less less, Key k) { Node::pop(mem, less, k); }
+  constexpr static Key pop(Mem mem, Less less, Read<Key> k)
+      NOEX(Node::pop(mem, less, k))
+
   constexpr static auto cons(auto mem, auto less, T e, Read<Key> node1)
       ARROW(Node::merge(mem, less, node1, Node::make1(mem, std::move(e))))
 
   template<class Mem>
-  static constexpr bool is_counted_node = requires(Mem mem, Node node) {
-    Node::count(mem, node);
+  static constexpr bool is_counted_node = requires(Mem mem, Key k) {
+    Node::count(mem, k);
   };
 
-  template<class Mem, class _>
+  template<class size_type, class Mem>
   requires(is_counted_node<Mem>) //
-      constexpr static auto count(Mem const mem, Read<Key> node)
-          NOEX(Node::count(mem, node))
+      constexpr static size_type count(Mem const mem, Read<Key> node)
+          NOEX(narrow<size_type>(Node::count(mem, node)))
 
   template<class size_type>
-  constexpr static size_type count(auto const mem, Read<Key> node)
-      NOEX(mem.is_null(node)
-               ? size_type{}
-               : (size_type{1} + count(mem[node].left())
-                  + count(mem[node].right())))
+  constexpr static size_type count(auto const mem, Read<Key> node) {
+    return mem.is_null(node)
+             ? size_type{}
+             : (size_type{1} + count<size_type>(mem, mem[node].left())
+                + count<size_type>(mem, mem[node].right()));
+  }
+};
+
+// Mems that trace their nodes need to know where the roots are. They say
+// so with a Root type: a Key wrapper that keeps itself registered with the
+// mem for as long as it lives, made by mem.root(key).
+template<class Mem, class Key>
+struct root_of {
+  using type = Key;
+};
+template<class Mem, class Key>
+requires requires { typename Mem::Root; }
+struct root_of<Mem, Key> {
+  using type = typename Mem::Root;
 };
 
+template<class Heap>
+class transient_heap;
+
 // we already need to say the mem and node types in order to construct
 // the vector for the vector memory
 template<class T, class Less, class Mem_, class Node_>
@@ -276,35 +557,250 @@ class Heap {
   using Key  = typename Node::Key;
 
   using NodeU = NodeUtil<Node>;
+  using Root  = typename root_of<Mem, Key>::type;
+
+  friend transient_heap<Heap>;
 
   [[no_unique_address]] Less        less_;
   [[no_unique_address]] mutable Mem mem_;
-  Key                               root_;
+  Root                              root_;
+
+  constexpr static Root rooted(Mem const& mem, Key h) {
+    if constexpr(std::is_same_v<Root, Key>) return h;
+    else return mem.root(std::move(h));
+  }
 
   constexpr Heap(Mem mem, Less less, Key h)
-      : less_{std::move(less)}, mem_{std::move(mem)}, root_{std::move(h)} {}
+      : less_{std::move(less)},
+        mem_{std::move(mem)},
+        root_{rooted(mem_, std::move(h))} {}
+
+  // from_range on threads [first, last), thread t making its nodes in
+  // mem_of(t). The range is split in two, the halves are built at once,
+  // each on its share of the threads, and then merged in the first
+  // half's mem: a tree of merges, whose levels run in parallel like the
+  // builds. A thread only reads the other half's nodes.
+  static Heap from_split(auto const&                             mem_of,
+                         Less const&                             less,
+                         std::ranges::random_access_range auto&& range,
+                         std::size_t                             last,
+                         std::size_t                             first = 0) {
+    auto const n       = static_cast<std::size_t>(std::ranges::size(range));
+    auto const threads = std::clamp<std::size_t>(
+        last - first, 1, std::max<std::size_t>(n, 1));
+    if(threads == 1) return from_range(mem_of(first), less, range);
+
+    auto const begin = std::ranges::begin(range);
+    auto const at    = [&](std::size_t i) {
+      return begin + static_cast<std::ptrdiff_t>(i);
+    };
+    auto const         mid   = first + threads / 2;
+    auto const         split = n * (threads / 2) / threads;
+    Heap               left{mem_of(first), less}, right{mem_of(mid), less};
+    std::exception_ptr error;
+    {
+      std::jthread worker{[&] {
+        try {
+          right = from_split(mem_of,
+                             less,
+                             std::ranges::subrange(at(split), at(n)),
+                             first + threads,
+                             mid);
+        } catch(...) {
+          error = std::current_exception();
+        }
+      }};
+      left = from_split(
+          mem_of, less, std::ranges::subrange(begin, at(split)), mid, first);
+    }
+    if(error) std::rethrow_exception(error);
+    auto const& mem = mem_of(first);
+    return Heap{mem, less, Node::merge(mem, less, left.root_, right.root_)};
+  }
 
  public:
   using size_type = std::size_t;
   constexpr explicit Heap(Mem mem = {}, Less less = {})
       : Heap(mem, std::move(less), mem.null()) {}
 
+  // wraps a node that already lives in mem
+  constexpr static Heap adopt(Mem mem, Key root, Less less = {})
+      NOEX(Heap{std::move(mem), std::move(less), std::move(root)})
+
+  // O(n), with exactly n nodes: heapify, then a complete binary tree is
+  // already leftist (the left side is always at least as full).
+  constexpr static Heap
+      from_range(Mem mem, Less less, std::ranges::input_range auto&& range) {
+    // not vector's iterator pair constructor: it wants a common range
+    std::vector<T> elts;
+    if constexpr(std::ranges::sized_range<decltype(range)>)
+      elts.reserve(static_cast<std::size_t>(std::ranges::size(range)));
+    std::ranges::copy(range, std::back_inserter(elts));
+    // std's heaps are max heaps
+    std::ranges::make_heap(elts, [&](auto const& a, auto const& b) {
+      return less(b, a);
+    });
+    auto const       n    = elts.size();
+    Key const        null = mem.null();
+    std::vector<Key> keys(n, null);
+    auto const       child = [&](std::size_t i) -> Key const& {
+      return i < n ? keys[i] : null;
+    };
+    for(auto i = n; i-- > 0;)
+      keys[i] = Node::make(
+          mem, std::move(elts[i]), child(2 * i + 1), child(2 * i + 2));
+    return Heap{std::move(mem), std::move(less), n > 0 ? keys[0] : null};
+  }
+
+  // from_range on several threads, each making nodes with its own copy
+  // of mem (see from_split). shared_ptr_mem shares nothing between them
+  // but malloc, whose arenas are per thread too. A slab_mem over atomic
+  // keys qualifies, but every node it makes takes the slab's lock, so its
+  // threads mostly wait on each other: give each thread an arena instead,
+  // with the overload below.
+  constexpr static Heap
+      from_range(Mem                                     mem,
+                 Less                                    less,
+                 std::ranges::random_access_range auto&& range,
+                 std::size_t                             threads)
+  requires thread_safe_mem<Mem> {
+    return from_split(
+        [&](std::size_t) -> Mem const& { return mem; }, less, range, threads);
+  }
+
+  // from_range with a thread per mem, each making nodes only in its own,
+  // e.g. an arena_mem per thread, each over its own arena. The heap keeps
+  // mems[0] and has the other mems' nodes in it, so their storage has to
+  // outlive it.
+  static Heap from_range_in(std::span<Mem const>                    mems,
+                            Less                                    less,
+                            std::ranges::random_access_range auto&& range)
+  requires shared_keys_mem<Mem> {
+    LEFTIST_HEAP_ASSERT(!mems.empty());
+    return from_split([&](std::size_t t) -> Mem const& { return mems[t]; },
+                      less,
+                      range,
+                      mems.size());
+  }
+
+  READER(less)
+  READER(mem)
+  constexpr ReadReturn<Key> root() const noexcept { return root_; }
+
   constexpr bool empty() const NOEX(mem_.is_null(root_))
 
   constexpr auto peek() const ARROW(NodeU::peek(mem_, root_))
 
-  constexpr Heap pop() const
+  constexpr Heap pop() const&
       NOEX(Heap{mem_, less_, NodeU::pop(mem_, less_, root_)})
 
-  constexpr Heap cons(T e) const
+  constexpr Heap cons(T e) const&
       NOEX(Heap{mem_, less_, NodeU::cons(mem_, less_, std::move(e), root_)})
 
+  // other has to live in the same mem
+  constexpr Heap merge(Heap const& other) const
+      NOEX(Heap{mem_, less_, Node::merge(mem_, less_, root_, other.root_)})
+
+  // std::move(h).pop() and .cons(e) reuse the nodes only h holds, e.g. a
+  // shared_ptr_mem's nodes whose use_count is 1 (see transient_heap).
+  // A vector_mem can't tell which nodes only h holds: its transient only
+  // owns the nodes made after it started, and a one-op transient has none
+  // yet, so these make the same new nodes the const& overloads do.
+  constexpr Heap pop() && {
+    auto t = std::move(*this).transient();
+    t.pop();
+    return std::move(t).persistent();
+  }
+  constexpr Heap cons(T e) && {
+    auto t = std::move(*this).transient();
+    t.cons(std::move(e));
+    return std::move(t).persistent();
+  }
+
   constexpr size_type size() const
-      NOEX(NodeU::template count<size_type>(root_))
+      NOEX(NodeU::template count<size_type>(mem_, root_))
+
+  // a copy of this heap that can be edited in place (see transient_heap)
+  constexpr auto transient() const& { return transient_heap<Heap>{*this}; }
+  constexpr auto transient() && {
+    return transient_heap<Heap>{std::move(*this)};
+  }
+};
+
+// A heap for a batch of pushes and pops, like Clojure's transients: the
+// nodes it made itself, or that nobody else can see, are overwritten
+// instead of copied. That takes a mem with epoch(), is_unique(key, epoch)
+// and overwrite(key, args...), and a Node with an owning merge (only Node
+// so far); anything else gets the usual copies. persistent() hands back a
+// Heap, after which the transient can't be used.
+//
+// With a vector_mem, nodes made after the transient started are its own:
+// nothing else may make nodes in the same block while it's open.
+template<class Heap>
+class transient_heap {
+  using Node = typename Heap::Node;
+  using Mem  = typename Heap::Mem;
+  using Key  = typename Heap::Key;
+  using T    = typename Node::element_t;
+
+  static constexpr bool in_place =
+      requires(Mem mem, decltype(Heap::less_) less, Key k) {
+    mem.is_unique(k, mem.epoch());
+    Node::merge(mem, less, k, k, [](Read<Key>) { return true; }, true, true);
+  };
+
+  static constexpr auto epoch_of(Mem const& mem) {
+    if constexpr(in_place) return mem.epoch();
+    else return no_epoch{};
+  }
+
+  Heap heap_;
+  [[no_unique_address]] decltype(epoch_of(std::declval<Mem const&>())) epoch_;
+
+  constexpr auto owned() const {
+    return [this](Read<Key> k) { return heap_.mem_.is_unique(k, epoch_); };
+  }
+
+ public:
+  constexpr explicit transient_heap(Heap heap)
+      : heap_{std::move(heap)}, epoch_{epoch_of(heap_.mem_)} {}
+  // A copy would have the same epoch, and both would overwrite the nodes
+  // they think are their own. Moving hands them over.
+  transient_heap(transient_heap const&)            = delete;
+  transient_heap& operator=(transient_heap const&) = delete;
+  transient_heap(transient_heap&&)                 = default;
+  transient_heap& operator=(transient_heap&&)      = default;
+
+  constexpr bool empty() const NOEX(heap_.empty())
+  constexpr auto peek() const ARROW(heap_.peek())
+  constexpr auto size() const ARROW(heap_.size())
+
+  constexpr transient_heap& cons(T e) {
+    if constexpr(in_place) {
+      auto& h = heap_;
+      Key const one = Node::make1(h.mem_, std::move(e));
+      h.root_ =
+          Node::merge(h.mem_, h.less_, h.root_, one, owned(), true, true);
+    } else heap_ = heap_.cons(std::move(e));
+    return *this;
+  }
+
+  constexpr transient_heap& pop() {
+    if constexpr(in_place) {
+      auto&       h   = heap_;
+      auto const& n   = h.mem_[h.root_];
+      bool const  own = owned()(h.root_);
+      h.root_ = Node::merge(
+          h.mem_, h.less_, n.left(), n.right(), owned(), own, own);
+    } else heap_ = heap_.pop();
+    return *this;
+  }
+
+  constexpr Heap persistent() && { return std::move(heap_); }
 };
 
 auto into(auto coll, auto data) {
-  for(auto&& d : data) coll = coll.cons(d);
+  for(auto&& d : data) coll = std::move(coll).cons(d);
   return coll;
 }
 #endif // LEFTIST_HEAP_HPP_INCLUDE_GUARD
@@ -0,0 +1,147 @@
+#ifndef LAZY_HPP_INCLUDE_GUARD
+#define LAZY_HPP_INCLUDE_GUARD
+
+#include "heap.hpp"
+
+#include <cstddef>
+#include <vector>
+
+// Okasaki's lazy pairing heap (Purely functional data structures, 6.5).
+// A node is an element, an "odd" child, and a suspended merge of the
+// rest. cons and merge only link two roots, the merging waits until a pop
+// forces it.
+//
+// A forced suspension is memoized in its node, so every version that
+// shares the node shares the work, which is what keeps the amortized
+// bounds when versions are reused (compare PairingNode's caveat). That
+// means forcing writes to nodes other heaps can see: don't share these
+// heaps between threads.
+template<class T, class key>
+class LazyPairingNode {
+ public:
+  using element_t = T;
+  using Key       = key;
+
+ private:
+  // merge(merge(a, b), force(from's suspension)), or once forced, a
+  struct suspension {
+    Key  a, b, from;
+    bool forced;
+  };
+
+  // clang-format off
+  enum                    { elt_i, left_i };
+  size_sorted_tuple<T    , Key   > data_;
+  // clang-format on
+  mutable suspension susp_;
+
+  struct permission2construct {
+    friend LazyPairingNode;
+
+   private:
+    permission2construct() = default;
+  };
+
+  constexpr static suspension done(Key k) noexcept {
+    return {k, {}, {}, true};
+  }
+
+  constexpr static Key
+      make_ug(auto mem, T e, Read<Key> left, suspension s)
+          NOEX(mem.template make_key(
+              permission2construct{}, std::move(e), left, std::move(s)))
+
+  // node1 is the least, node2 goes under it
+  constexpr static Key link(auto mem, Read<Key> node1, Read<Key> node2) {
+    auto const& n = mem[node1];
+    if(mem.is_null(n.left()))
+      return make_ug(mem,
+                     n.elt(),
+                     node2,
+                     n.susp_.forced ? done(n.susp_.a)
+                                    : suspension{mem.null(),
+                                                 mem.null(),
+                                                 node1,
+                                                 false});
+    return make_ug(mem,
+                   n.elt(),
+                   mem.null(),
+                   suspension{node2, n.left(), node1, false});
+  }
+
+  // k's suspended merge, forcing it and the ones it continues if need be
+  constexpr static Key force(auto mem, auto less, Read<Key> k) {
+    std::vector<Key> chain;
+    Key              from = k;
+    while(!mem.is_null(from) && !mem[from].susp_.forced) {
+      chain.push_back(from);
+      from = mem[from].susp_.from;
+    }
+    Key value = mem.is_null(from) ? mem.null() : mem[from].susp_.a;
+    while(!chain.empty()) {
+      Key const c = std::move(chain.back());
+      chain.pop_back();
+      Key const ab = merge(mem, less, mem[c].susp_.a, mem[c].susp_.b);
+      value        = merge(mem, less, ab, value);
+      mem[c].susp_ = done(value);
+    }
+    return value;
+  }
+
+  constexpr static std::size_t count_susp(auto const mem, Read<Key> k) {
+    auto const& s = mem[k].susp_;
+    return count(mem, s.a)
+         + (s.forced ? 0
+                     : count(mem, s.b)
+                           + (mem.is_null(s.from) ? 0
+                                                  : count_susp(mem, s.from)));
+  }
+
+ public:
+  LazyPairingNode() = default;
+  LazyPairingNode(permission2construct, T elt, Key left, suspension s)
+      : data_{std::move(elt), std::move(left)}, susp_{std::move(s)} {}
+
+  // conses make O(n) chains of suspensions, see drop_keys
+  ~LazyPairingNode() requires owning_key<Key> {
+    drop_keys(data_.template get<left_i>(), susp_.a, susp_.b, susp_.from);
+  }
+  ~LazyPairingNode()                                 = default;
+  LazyPairingNode(LazyPairingNode const&)            = default;
+  LazyPairingNode(LazyPairingNode&&)                 = default;
+  LazyPairingNode& operator=(LazyPairingNode const&) = default;
+  LazyPairingNode& operator=(LazyPairingNode&&)      = default;
+
+  READER(elt, data_.template get<elt_i>())
+  READER(left, data_.template get<left_i>())
+
+  // a root with the heaps node1 and node2 below it
+  constexpr static Key make(auto mem, T e, Read<Key> node1, Read<Key> node2)
+      NOEX(make_ug(mem, std::move(e), node1, done(node2)))
+
+  constexpr static auto make1(auto mem, T e)
+      ARROW(make_ug(mem, std::move(e), mem.null(), done(mem.null())))
+
+  constexpr static Key
+      merge(auto mem, auto less, Read<Key> node1, Read<Key> node2) {
+    if(mem.is_null(node1)) return node2;
+    if(mem.is_null(node2)) return node1;
+    return less(mem[node2].elt(), mem[node1].elt())
+             ? link(mem, node2, node1)
+             : link(mem, node1, node2);
+  }
+
+  constexpr static Key pop(auto mem, auto less, Read<Key> k) {
+    auto const rest = force(mem, less, k);
+    return merge(mem, less, mem[k].left(), rest);
+  }
+
+  // without forcing anything
+  constexpr static std::size_t count(auto const mem, Read<Key> k) {
+    return mem.is_null(k)
+             ? 0
+             : 1 + count(mem, mem[k].left()) + count_susp(mem, k);
+  }
+};
+
+#endif // LAZY_HPP_INCLUDE_GUARD
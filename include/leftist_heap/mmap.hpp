@@ -0,0 +1,174 @@
+#ifndef MMAP_HPP_INCLUDE_GUARD
+#define MMAP_HPP_INCLUDE_GUARD
+
+#include "heap.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+[[noreturn]] inline void throw_errno(char const* what) {
+  throw std::system_error(errno, std::generic_category(), what);
+}
+
+// An fd and a shared read-write mapping of its first size() bytes.
+class mapped_region {
+  int         fd_   = -1;
+  void*       addr_ = nullptr;
+  std::size_t size_ = 0;
+
+ public:
+  mapped_region() = default;
+  // takes ownership of fd
+  explicit mapped_region(int fd) : fd_{fd} {
+    struct stat st;
+    if(::fstat(fd_, &st) != 0) throw_errno("fstat");
+    if(st.st_size > 0) map(static_cast<std::size_t>(st.st_size));
+  }
+  mapped_region(mapped_region&& other) noexcept
+      : fd_{std::exchange(other.fd_, -1)},
+        addr_{std::exchange(other.addr_, nullptr)},
+        size_{std::exchange(other.size_, 0)} {}
+  mapped_region& operator=(mapped_region other) noexcept {
+    std::swap(fd_, other.fd_);
+    std::swap(addr_, other.addr_);
+    std::swap(size_, other.size_);
+    return *this;
+  }
+  ~mapped_region() {
+    if(addr_ != nullptr) ::munmap(addr_, size_);
+    if(fd_ >= 0) ::close(fd_);
+  }
+
+  std::byte* data() const noexcept {
+    return static_cast<std::byte*>(addr_);
+  }
+  std::size_t size() const noexcept { return size_; }
+
+  // grows the file as well as the mapping, the mapping may move
+  void resize(std::size_t size) {
+    if(::ftruncate(fd_, static_cast<off_t>(size)) != 0)
+      throw_errno("ftruncate");
+    map(size);
+  }
+
+  void sync() const {
+    if(addr_ != nullptr && ::msync(addr_, size_, MS_SYNC) != 0)
+      throw_errno("msync");
+  }
+
+ private:
+  void map(std::size_t size) {
+    auto const addr =
+        ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if(addr == MAP_FAILED) throw_errno("mmap");
+    if(addr_ != nullptr) ::munmap(addr_, size_);
+    addr_ = addr;
+    size_ = size;
+  }
+};
+
+// A block of nodes that lives in a file, so a heap survives restarts.
+// Keys are 1-based node offsets from the start of the block, not
+// pointers: reopening just maps the file again, with no rebuild and no
+// deserialization, and the mapping can grow and move without invalidating
+// any key.
+//
+// Nodes are only ever appended, and never change once written. A root that
+// was checkpoint()ed stays valid whatever happens to the file later.
+template<class T>
+class mapped_file {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "nodes are stored as raw bytes");
+  static_assert(alignof(T) <= 64);
+
+  struct header {
+    std::uint64_t magic;
+    std::uint64_t node_size;
+    std::uint64_t count;
+    std::uint64_t root;
+  };
+  static constexpr std::uint64_t magic       = 0x7061'6568'7473'6966;
+  static constexpr std::size_t   header_size = 64;
+
+  mapped_region region_;
+
+  static int open_file(char const* path) {
+    auto const fd = ::open(path, O_RDWR | O_CREAT, 0644);
+    if(fd < 0) throw_errno("open");
+    return fd;
+  }
+
+  header& head() const noexcept {
+    return *reinterpret_cast<header*>(region_.data());
+  }
+  T* nodes() const noexcept {
+    return reinterpret_cast<T*>(region_.data() + header_size);
+  }
+
+ public:
+  using Key = std::uint64_t;
+
+  explicit mapped_file(char const* path, std::size_t capacity = 1024)
+      : region_{open_file(path)} {
+    if(region_.size() == 0) {
+      region_.resize(header_size + capacity * sizeof(T));
+      head() = {magic, sizeof(T), 0, 0};
+    } else if(region_.size() < header_size || head().magic != magic
+              || head().node_size != sizeof(T)) {
+      throw std::runtime_error{"not a heap file for this node type"};
+    }
+  }
+
+  std::size_t size() const noexcept { return head().count; }
+  std::size_t capacity() const noexcept {
+    return (region_.size() - header_size) / sizeof(T);
+  }
+
+  T const& operator[](Key i) const
+      noexcept(LEFTIST_HEAP_ASSERT_NOEXCEPT) {
+    LEFTIST_HEAP_ASSERT(0 < i && i <= size());
+    return nodes()[i - 1];
+  }
+
+  Key make(auto&&... args) {
+    if(size() == capacity())
+      region_.resize(header_size
+                     + std::max<std::size_t>(2 * capacity(), 1) * sizeof(T));
+    std::construct_at(nodes() + size(), FWD(args)...);
+    return ++head().count;
+  }
+
+  // the root a restarted process should pick up
+  Key  root() const noexcept { return head().root; }
+  void set_root(Key root) noexcept { head().root = root; }
+
+  // flushes every node and the root to disk
+  void checkpoint() const { region_.sync(); }
+};
+
+template<class T>
+struct mmap_mem {
+  using Key = typename mapped_file<T>::Key;
+  mapped_file<T>* file;
+
+  T const& operator[](Key i) const NOEX((*file)[i])
+
+  constexpr Key  null() const noexcept { return 0; }
+  constexpr bool is_null(Key i) const noexcept { return i == 0; }
+
+  Key make_key(auto&&... args) NOEX(file->make(FWD(args)...))
+};
+
+#endif // MMAP_HPP_INCLUDE_GUARD
@@ -0,0 +1,172 @@
+#ifndef NURSERY_HPP_INCLUDE_GUARD
+#define NURSERY_HPP_INCLUDE_GUARD
+
+#include "gc.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+struct generation_stats {
+  std::size_t allocated   = 0; // nodes ever made in the nursery
+  std::size_t promoted    = 0; // of those, nodes copied to old space
+  std::size_t collections = 0;
+
+  double promotion_rate() const noexcept {
+    return allocated == 0 ? 0.0
+                          : static_cast<double>(promoted)
+                                / static_cast<double>(allocated);
+  }
+};
+
+// Two generations. New nodes are bumped into a nursery, most of them are
+// path copies that are dead by the next pop. A minor collection copies the
+// nursery nodes still reachable from the registered roots into old space
+// and throws the rest of the nursery away wholesale.
+//
+// Nodes are immutable, so an old node can never point at a young one:
+// the roots are the only pointers into the nursery and no write barrier
+// is needed. Old space is a gc_space, major_collect() sweeps it.
+//
+// Keys with the top bit set are nursery slots. As with gc_mem, only
+// collect between operations.
+template<class T,
+         class Index           = std::uint32_t,
+         std::size_t ChunkSize = 1024>
+class nursery_space {
+  static constexpr Index young_bit =
+      Index{1} << (std::numeric_limits<Index>::digits - 1);
+
+  gc_space<T, Index, ChunkSize> old_;
+  chunk_list<T, ChunkSize>      nursery_;
+  std::size_t                   young_ = 0;
+  generation_stats              stats_;
+
+  static constexpr bool is_young(Index k) noexcept {
+    return (k & young_bit) != 0;
+  }
+  // 0-based nursery slot
+  static constexpr std::size_t offset(Index k) noexcept {
+    return static_cast<std::size_t>(k & ~young_bit) - 1;
+  }
+
+  struct old_mem {
+    gc_space<T, Index, ChunkSize>* old;
+    auto make_key(auto&&... args) NOEX(old->make(FWD(args)...))
+  };
+
+ public:
+  nursery_space() = default;
+  nursery_space(nursery_space const&) = delete;
+  ~nursery_space() { drop_nursery(); }
+
+  root_list<Index>*       roots() noexcept { return old_.roots(); }
+  generation_stats const& stats() const noexcept { return stats_; }
+  std::size_t             nursery_size() const noexcept { return young_; }
+  std::size_t             old_size() const noexcept { return old_.live(); }
+
+  T const& operator[](Index k) const
+      noexcept(LEFTIST_HEAP_ASSERT_NOEXCEPT) {
+    if(is_young(k)) {
+      LEFTIST_HEAP_ASSERT(offset(k) < young_);
+      return *nursery_.slot(offset(k));
+    }
+    return old_[k];
+  }
+
+  Index make(auto&&... args) {
+    if(young_ == nursery_.capacity()) nursery_.add_chunk();
+    std::construct_at(nursery_.slot(young_), FWD(args)...);
+    auto const k = narrow<Index>(++young_);
+    LEFTIST_HEAP_ASSERT(!is_young(k));
+    return k | young_bit;
+  }
+
+  // returns the number of nodes promoted
+  std::size_t minor_collect() {
+    enum : std::uint8_t { unseen, pending, done };
+    std::vector<std::uint8_t>           seen(young_, unseen);
+    std::vector<Index>                  forward(young_);
+    std::vector<std::pair<Index, bool>> todo;
+    roots()->for_each([&](Index k) {
+      if(is_young(k)) todo.emplace_back(k, false);
+    });
+
+    auto const moved = [&](Index k) {
+      return is_young(k) ? forward[offset(k)] : k;
+    };
+
+    // postorder, so children are promoted before their parents
+    std::size_t promoted = 0;
+    while(!todo.empty()) {
+      auto const [k, children_done] = todo.back();
+      todo.pop_back();
+      auto& s = seen[offset(k)];
+      if(children_done) {
+        auto const& n      = (*this)[k];
+        forward[offset(k)] = T::relink(
+            old_mem{&old_}, n, moved(n.left()), moved(n.right()));
+        LEFTIST_HEAP_ASSERT(!is_young(forward[offset(k)]));
+        s = done;
+        ++promoted;
+        continue;
+      }
+      if(s != unseen) continue;
+      s = pending;
+      todo.emplace_back(k, true);
+      for(auto const child : {(*this)[k].left(), (*this)[k].right()})
+        if(is_young(child) && seen[offset(child)] == unseen)
+          todo.emplace_back(child, false);
+    }
+    roots()->for_each([&](Index& k) { k = moved(k); });
+
+    stats_.allocated += young_;
+    stats_.promoted += promoted;
+    ++stats_.collections;
+    drop_nursery();
+    return promoted;
+  }
+
+  // returns the number of old nodes freed
+  std::size_t major_collect() {
+    minor_collect();
+    return old_.collect();
+  }
+
+ private:
+  void drop_nursery() noexcept {
+    if constexpr(!std::is_trivially_destructible_v<T>)
+      for(std::size_t i = 0; i < young_; ++i)
+        std::destroy_at(nursery_.slot(i));
+    young_ = 0;
+  }
+};
+
+template<class T,
+         class Index           = std::uint32_t,
+         std::size_t ChunkSize = 1024>
+struct nursery_mem {
+  using Key  = Index;
+  using Root = gc_root<Key>;
+  nursery_space<T, Index, ChunkSize>* space;
+
+  T const& operator[](Key i) const noexcept(LEFTIST_HEAP_ASSERT_NOEXCEPT) {
+    LEFTIST_HEAP_ASSERT(!is_null(i));
+    return (*space)[i];
+  }
+
+  constexpr Key  null() const noexcept { return 0; }
+  constexpr bool is_null(Key i) const noexcept { return i == 0; }
+
+  Key make_key(auto&&... args) NOEX(space->make(FWD(args)...))
+
+  Root root(Key k) const noexcept {
+    return space ? Root{space->roots(), k} : Root{k};
+  }
+};
+
+#endif // NURSERY_HPP_INCLUDE_GUARD
@@ -0,0 +1,134 @@
+#ifndef PACKED_HPP_INCLUDE_GUARD
+#define PACKED_HPP_INCLUDE_GUARD
+
+#include "heap.hpp"
+
+#include <bit>
+#include <limits>
+#include <type_traits>
+
+// rank <= floor(log(n+1)) (see Node), so with a 64 bit index key the rank
+// of the node a key points to fits in the key's top 6 bits. Keeping it
+// there instead of in the node saves the rank byte, and merge can compare
+// ranks without loading either node.
+//
+// Node already packs its rank into what would otherwise be padding, so
+// that byte only shrinks a node when the other fields fill their
+// alignment: a PackedNode<int, uint32_t> is 12 bytes against 16, and a
+// PackedNode<int64_t, uint64_t> 24 against 32, but a PackedNode<int,
+// uint64_t> is 24 bytes, same as Node.
+template<class Key>
+constexpr int default_rank_bits =
+    std::bit_width(unsigned{std::numeric_limits<Key>::digits}) - 1;
+
+// Index bits left over once the rank is packed in.
+template<class Key, int RankBits>
+constexpr int index_bits = std::numeric_limits<Key>::digits - RankBits;
+
+// A mem adapter for keys that carry a rank: strips the rank before
+// handing the key to Mem. Nodes tag the keys make_key returns.
+template<class Mem, int RankBits = default_rank_bits<typename Mem::Key>>
+struct rank_tagged_mem {
+  using Key = typename Mem::Key;
+  static_assert(std::is_unsigned_v<Key>);
+  static constexpr Key index_mask =
+      (Key{1} << index_bits<Key, RankBits>) - 1;
+
+  Mem base;
+
+  constexpr auto const& operator[](Key i) const NOEX(base[i & index_mask])
+  constexpr Key  null() const NOEX(base.null())
+  constexpr bool is_null(Key i) const NOEX(base.is_null(i & index_mask))
+  constexpr auto make_key(auto&&... args)
+      ARROW(base.make_key(FWD(args)...))
+};
+
+// Node, minus the rank: a key's top RankBits are the rank of the node it
+// points to. Use with a rank_tagged_mem over an index mem.
+template<class T,
+         class key    = std::uint64_t,
+         int RankBits = default_rank_bits<key>>
+class PackedNode {
+ public:
+  using element_t = T;
+  using Key       = key;
+
+ private:
+  static constexpr int shift = index_bits<Key, RankBits>;
+  // the rank can't exceed the number of index bits
+  static_assert(shift < (1 << RankBits));
+
+  T   elt_;
+  Key left_;
+  Key right_;
+
+  constexpr static Key rank_of(Read<Key> n) noexcept { return n >> shift; }
+
+  constexpr static Key tag(Read<Key> n, Key rank)
+      noexcept(LEFTIST_HEAP_ASSERT_NOEXCEPT) {
+    LEFTIST_HEAP_ASSERT(rank_of(n) == 0);
+    LEFTIST_HEAP_ASSERT(rank < (Key{1} << RankBits));
+    return n | static_cast<Key>(rank << shift);
+  }
+
+  struct permission2construct {
+    friend PackedNode;
+
+   private:
+    permission2construct() = default;
+  };
+
+ public:
+  PackedNode() = default;
+  PackedNode(permission2construct, T elt, Key left, Key right)
+      : elt_{std::move(elt)},
+        left_{std::move(left)},
+        right_{std::move(right)} {}
+
+  READER(elt)
+  READER(left)
+  READER(right)
+
+  constexpr static Key make(auto mem, T e, Read<Key> node1, Read<Key> node2)
+      noexcept(noexcept(mem.make_key(node1))) {
+    auto const& [r, l] =
+        std::minmax(node1, node2, cmp_by([] FN(rank_of(_))));
+    return tag(mem.template make_key(
+                   permission2construct{}, std::move(e), l, r),
+               rank_of(r) + 1);
+  }
+
+  constexpr static auto make1(auto mem, auto e)
+      ARROW(make(mem, std::move(e), mem.null(), mem.null()))
+
+  constexpr static Key
+      relink(auto mem, PackedNode const& n, Read<Key> left, Read<Key> right)
+          NOEX(tag(mem.template make_key(
+                       permission2construct{}, n.elt_, left, right),
+                   rank_of(right) + 1))
+
+  constexpr static Key
+      merge(auto mem, auto less, Read<Key> node1, Read<Key> node2) noexcept(
+          noexcept(mem.is_null(node1),
+                   less(mem[node2].elt(), mem[node1].elt()),
+                   make(mem, mem[node1].elt(), node1, node2))) {
+    return mem.is_null(node1) ? node2
+         : mem.is_null(node2) ? node1
+         : less(mem[node2].elt(), mem[node1].elt())
+             ? make(mem,
+                    mem[node2].elt(),
+                    mem[node2].left(),
+                    merge(mem, less, node1, mem[node2].right()))
+             : make(mem,
+                    mem[node1].elt(),
+                    mem[node1].left(),
+                    merge(mem, less, node2, mem[node1].right()));
+  }
+};
+
+static_assert(sizeof(PackedNode<int, std::uint32_t>) == 12);
+static_assert(sizeof(Node<int, std::uint32_t>) == 16);
+static_assert(sizeof(PackedNode<int, std::uint64_t>)
+              == sizeof(Node<int, std::uint64_t>));
+
+#endif // PACKED_HPP_INCLUDE_GUARD
@@ -0,0 +1,128 @@
+#ifndef PAIRING_HPP_INCLUDE_GUARD
+#define PAIRING_HPP_INCLUDE_GUARD
+
+#include "heap.hpp"
+
+#include <cstddef>
+#include <vector>
+
+// A pairing heap, in the usual binary form: left is a node's first child
+// and right is its next sibling, so a root has no right. cons and merge
+// are O(1), they just link two roots. pop does the work: it pairs up the
+// root's children left to right, then merges the pairs right to left.
+//
+// Linking puts one root at the front of the other's child list, which
+// means a copy of it with a new sibling: two nodes per link.
+//
+// Caveat: pop is only O(log n) amortized, and like SkewNode's that
+// assumes each version is used once. A heap built by n conses has a root
+// with about n children, and every pop of that same version pays for all
+// of them again.
+template<class T, class key>
+class PairingNode {
+ public:
+  using element_t = T;
+  using Key       = key;
+
+ private:
+  // clang-format off
+  enum                    { elt_i, left_i, right_i };
+  size_sorted_tuple<T    , Key   , Key    > data_;
+  // clang-format on
+
+  struct permission2construct {
+    friend PairingNode;
+
+   private:
+    permission2construct() = default;
+  };
+
+  constexpr static Key
+      make_ug(auto mem, T e, Read<Key> child, Read<Key> sibling)
+          NOEX(mem.template make_key(
+              permission2construct{}, std::move(e), child, sibling))
+
+  // node1 and node2 as trees, whatever their siblings
+  constexpr static Key
+      link(auto mem, auto less, Read<Key> node1, Read<Key> node2) {
+    auto const& [lo, hi] = less(mem[node2].elt(), mem[node1].elt())
+                             ? std::pair<Read<Key>, Read<Key>>{node2, node1}
+                             : std::pair<Read<Key>, Read<Key>>{node1, node2};
+    // one make at a time: with a vector_mem, making a node moves the rest
+    auto const child = make_ug(
+        mem, mem[hi].elt(), mem[hi].left(), mem[lo].left());
+    return make_ug(mem, mem[lo].elt(), child, mem.null());
+  }
+
+ public:
+  PairingNode() = default;
+  PairingNode(permission2construct, T elt, Key left, Key right)
+      : data_{std::move(elt), std::move(left), std::move(right)} {}
+
+  // a heap built by conses has an O(n) sibling list, see drop_keys
+  ~PairingNode() requires owning_key<Key> {
+    drop_keys(data_.template get<left_i>(), data_.template get<right_i>());
+  }
+  ~PairingNode()                             = default;
+  PairingNode(PairingNode const&)            = default;
+  PairingNode(PairingNode&&)                 = default;
+  PairingNode& operator=(PairingNode const&) = default;
+  PairingNode& operator=(PairingNode&&)      = default;
+
+  READER(elt, data_.template get<elt_i>())
+  READER(left, data_.template get<left_i>())
+  READER(right, data_.template get<right_i>())
+
+  // a root with the heaps node1 and node2 as its children
+  constexpr static Key make(auto mem, T e, Read<Key> node1, Read<Key> node2) {
+    if(mem.is_null(node1) || mem.is_null(node2))
+      return make_ug(mem,
+                     std::move(e),
+                     mem.is_null(node1) ? node2 : node1,
+                     mem.null());
+    auto const& n = mem[node1];
+    return make_ug(
+        mem, std::move(e), make_ug(mem, n.elt(), n.left(), node2), mem.null());
+  }
+
+  constexpr static auto make1(auto mem, auto e)
+      ARROW(make_ug(mem, std::move(e), mem.null(), mem.null()))
+
+  constexpr static Key
+      relink(auto mem, PairingNode const& n, Read<Key> left, Read<Key> right)
+          NOEX(make_ug(mem, n.elt(), left, right))
+
+  constexpr static Key
+      merge(auto mem, auto less, Read<Key> node1, Read<Key> node2) {
+    if(mem.is_null(node1)) return node2;
+    if(mem.is_null(node2)) return node1;
+    [[maybe_unused]] auto const reserved = reserve_keys(mem, 2);
+    return link(mem, less, node1, node2);
+  }
+
+  constexpr static Key pop(auto mem, auto less, Read<Key> k) {
+    std::vector<key_ref<Key>> kids;
+    for(key_ref<Key> c = mem[k].left(); !mem.is_null(c.get());
+        c              = mem[c.get()].right())
+      kids.push_back(c);
+    if(kids.empty()) return mem.null();
+    auto const m = kids.size();
+    [[maybe_unused]] auto const reserved = reserve_keys(mem, 2 * (m - 1));
+
+    std::vector<Key> pairs;
+    pairs.reserve((m + 1) / 2);
+    for(std::size_t i = 0; i + 1 < m; i += 2)
+      pairs.push_back(link(mem, less, kids[i].get(), kids[i + 1].get()));
+    // the last child has no sibling, it's a heap as it is
+    if(m % 2 == 1) pairs.push_back(kids.back().get());
+
+    Key merged = pairs.back();
+    for(auto i = pairs.size() - 1; i-- > 0;)
+      merged = link(mem, less, pairs[i], merged);
+    return merged;
+  }
+};
+
+static_assert(sizeof(PairingNode<int, std::uint32_t>) == 12);
+
+#endif // PAIRING_HPP_INCLUDE_GUARD
@@ -0,0 +1,198 @@
+#ifndef RUNS_HPP_INCLUDE_GUARD
+#define RUNS_HPP_INCLUDE_GUARD
+
+#include "macros.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// One allocation carved up for a run of allocate_shared'd nodes, e.g. a
+// freshly merged right spine: one malloc instead of one per node, and the
+// spine ends up contiguous. The run is freed once every node in it is,
+// so a long-lived node keeps its whole run alive.
+class node_run {
+  // nodes alive, plus one while the run still hands out slots
+  std::atomic<std::size_t> refs_{1};
+  std::size_t              size_;
+  std::size_t              used_ = 0;
+
+  explicit node_run(std::size_t size) noexcept : size_{size} {}
+
+  std::byte* data() noexcept {
+    return reinterpret_cast<std::byte*>(this) + header_size;
+  }
+
+ public:
+  static constexpr std::size_t header_size =
+      (sizeof(std::atomic<std::size_t>) + 2 * sizeof(std::size_t)
+       + __STDCPP_DEFAULT_NEW_ALIGNMENT__ - 1)
+      / __STDCPP_DEFAULT_NEW_ALIGNMENT__ * __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+  static node_run* make(std::size_t size) {
+    return ::new(::operator new(header_size + size)) node_run{size};
+  }
+
+  // nullptr if it doesn't fit
+  void* take(std::size_t bytes, std::size_t align) noexcept {
+    if(align > __STDCPP_DEFAULT_NEW_ALIGNMENT__) return nullptr;
+    auto const start = (used_ + align - 1) / align * align;
+    if(start + bytes > size_) return nullptr;
+    used_ = start + bytes;
+    refs_.fetch_add(1, std::memory_order_relaxed);
+    return data() + start;
+  }
+
+  bool owns(void const* p) noexcept {
+    auto const b = static_cast<std::byte const*>(p);
+    return data() <= b && b < data() + size_;
+  }
+
+  // a node made somewhere else, that drops a ref all the same
+  void hold() noexcept { refs_.fetch_add(1, std::memory_order_relaxed); }
+
+  void drop() noexcept {
+    if(refs_.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+    this->~node_run();
+    ::operator delete(this);
+  }
+};
+
+// Records how much allocate_shared asks for, see shared_node_size.
+template<class T>
+struct size_probe {
+  using value_type = T;
+  std::size_t* size;
+
+  explicit size_probe(std::size_t* s) noexcept : size{s} {}
+  template<class U>
+  size_probe(size_probe<U> const& other) noexcept : size{other.size} {}
+
+  T* allocate(std::size_t n) {
+    *size = n * sizeof(T);
+    return std::allocator<T>{}.allocate(n);
+  }
+  void deallocate(T* p, std::size_t n) noexcept {
+    std::allocator<T>{}.deallocate(p, n);
+  }
+
+  template<class U>
+  bool operator==(size_probe<U> const&) const noexcept {
+    return true;
+  }
+};
+
+// Allocates from a run while it has room, from the heap after that. Both
+// kinds hold a ref on the run, so deallocate can always drop one: the
+// allocator's copy in a heap allocated node would otherwise point at a
+// run that may be gone.
+template<class T>
+struct run_allocator {
+  using value_type = T;
+  node_run* run;
+
+  explicit run_allocator(node_run* r) noexcept : run{r} {}
+  template<class U>
+  run_allocator(run_allocator<U> const& other) noexcept : run{other.run} {}
+
+  T* allocate(std::size_t n) {
+    if(auto const p = run->take(n * sizeof(T), alignof(T)))
+      return static_cast<T*>(p);
+    auto const p = std::allocator<T>{}.allocate(n);
+    run->hold();
+    return p;
+  }
+  void deallocate(T* p, std::size_t n) noexcept {
+    if(!run->owns(p)) std::allocator<T>{}.deallocate(p, n);
+    run->drop();
+  }
+
+  template<class U>
+  bool operator==(run_allocator<U> const& other) const noexcept {
+    return run == other.run;
+  }
+};
+
+// What allocate_shared<T> asks its allocator for: T plus the control
+// block's counts, vtable and allocator. It's measured once, by making a
+// T, when T can be default constructed; otherwise it's a guess, and a
+// node that doesn't fit its slot just goes to the heap.
+template<class T>
+std::size_t shared_node_size() {
+  if constexpr(std::is_default_constructible_v<T>) {
+    static std::size_t const size = [] {
+      std::size_t measured = 0;
+      std::allocate_shared<T>(size_probe<T>{&measured});
+      return measured;
+    }();
+    return size;
+  } else {
+    return sizeof(T) + 4 * sizeof(void*);
+  }
+}
+
+// The run the calling thread is filling with Ts, if any. Each T has its
+// own, so making some other kind of node in the middle of a run doesn't
+// land in it.
+template<class T>
+class run_cache {
+  node_run*   run_  = nullptr;
+  std::size_t left_ = 0; // nodes still expected
+
+  run_cache() = default;
+
+ public:
+  // Longer spines make their first max_run nodes in a run and the rest
+  // on their own: one long-lived node keeps its whole run alive, so runs
+  // are kept short.
+  static constexpr std::size_t max_run = 64;
+
+  static run_cache& local() noexcept {
+    thread_local run_cache cache;
+    return cache;
+  }
+
+  node_run* run() const noexcept { return run_; }
+  bool      active() const noexcept { return left_ > 0; }
+
+  void start(std::size_t k) {
+    finish();
+    k     = std::min(k, max_run);
+    run_  = node_run::make(k * shared_node_size<T>());
+    left_ = k;
+  }
+
+  // one of the run's nodes is made
+  void took() noexcept {
+    if(--left_ == 0) finish();
+  }
+
+  void finish() noexcept {
+    if(run_ != nullptr) std::exchange(run_, nullptr)->drop();
+    left_ = 0;
+  }
+
+  ~run_cache() { finish(); }
+};
+
+// Ends a run when it goes out of scope, whether or not all its nodes got
+// made, e.g. because making one threw.
+template<class T>
+class [[nodiscard]] run_scope {
+  run_cache<T>* cache_;
+
+ public:
+  explicit run_scope(run_cache<T>* cache) noexcept : cache_{cache} {}
+  run_scope(run_scope&& other) noexcept
+      : cache_{std::exchange(other.cache_, nullptr)} {}
+  run_scope& operator=(run_scope&&) = delete;
+  ~run_scope() {
+    if(cache_ != nullptr) cache_->finish();
+  }
+};
+
+#endif // RUNS_HPP_INCLUDE_GUARD
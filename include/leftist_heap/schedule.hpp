@@ -0,0 +1,205 @@
+#ifndef SCHEDULE_HPP_INCLUDE_GUARD
+#define SCHEDULE_HPP_INCLUDE_GUARD
+
+#include "heap.hpp"
+#include "packed.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// A heap whose cons and pop do at most budget steps of merging each, for
+// when the worst case matters more than the average.
+//
+// It's a handful of parts, each an ordinary tree of Nodes, kept in a
+// binary heap by their roots, plus at most one merge of two parts in
+// progress. pop takes the least root and leaves its children as two new
+// parts, cons adds a one node part, and then the merge goes on for up to
+// budget steps (a step visits one node on the way down the right spines,
+// or makes one on the way back up). peek looks at the least part and the
+// merge's two inputs. pop and cons also cost O(log parts).
+//
+// No budget keeps up for every n: n pops sort n elements, which takes
+// O(n log n) comparisons, so a pop can't be O(1) in general. Merging two
+// parts takes about 4 log2(n) steps; with a smaller budget the parts pile
+// up instead. If a pop wants the least root from the merge in progress,
+// the merge is abandoned and its inputs go back to the parts. The nodes
+// it already made on the way back up are dropped with it (a vector_mem
+// keeps them until it's compacted), and that merge starts over later.
+//
+// Unlike Heap, cons and pop change the heap in place: it's a worklist
+// more than a value, and copying one copies its parts and the merge's
+// path. Keeping those in shared nodes instead would make every version
+// pay for them. persistent() gets an ordinary Heap back out.
+//
+// Node is a binary leftist node, a Node, WeightNode or PackedNode: its
+// right child is a subtree, its right spine is O(log n) long, and make(e,
+// left, merged) puts the shorter side on the right, which is what keeps
+// the merges short. Other nodes get the same heap order but lose that:
+// a SkewNode only keeps its spines short by swapping in its own merge, so
+// built back up with make they grow without bound. A PairingNode's right
+// is a sibling, not a child, and pop would lose elements.
+template<class Node>
+inline constexpr bool is_leftist_node = false;
+template<class T, class Key, class Rank>
+inline constexpr bool is_leftist_node<Node<T, Key, Rank>> = true;
+template<class T, class Key, class Weight>
+inline constexpr bool is_leftist_node<WeightNode<T, Key, Weight>> = true;
+template<class T, class Key, int RankBits>
+inline constexpr bool is_leftist_node<PackedNode<T, Key, RankBits>> =
+    true;
+
+template<class T, class Less, class Mem, class Node>
+class ScheduledHeap {
+  static_assert(is_leftist_node<Node>,
+                "ScheduledHeap takes a Node, WeightNode or PackedNode");
+  using Key   = typename Node::Key;
+  using NodeU = NodeUtil<Node>;
+
+  [[no_unique_address]] Less        less_;
+  [[no_unique_address]] mutable Mem mem_;
+  std::size_t                       budget_;
+  // least root first (std heaps are max heaps)
+  std::vector<Key> parts_;
+
+  struct merge_job {
+    bool             active = false, building = false;
+    Key              a{}, b{}; // the parts it merges
+    Key              x{}, y{}; // where the descent is
+    Key              merged{};
+    std::vector<Key> path;
+  } job_;
+
+  constexpr bool later(Read<Key> p, Read<Key> q) const {
+    return less_(NodeU::peek(mem_, q), NodeU::peek(mem_, p));
+  }
+  constexpr auto const& job_least() const {
+    return later(job_.a, job_.b) ? job_.b : job_.a;
+  }
+
+  constexpr void add(Read<Key> k) {
+    if(mem_.is_null(k)) return;
+    parts_.push_back(k);
+    std::push_heap(parts_.begin(), parts_.end(), [this](auto& p, auto& q) {
+      return later(p, q);
+    });
+  }
+
+  constexpr void start() {
+    job_.a = std::move(parts_.back());
+    parts_.pop_back();
+    job_.b = std::move(parts_.back());
+    parts_.pop_back();
+    job_.x        = job_.a;
+    job_.y        = job_.b;
+    job_.active   = true;
+    job_.building = false;
+  }
+
+  constexpr void cancel() {
+    add(job_.a);
+    add(job_.b);
+    job_.active = false;
+    job_.path.clear();
+  }
+
+  constexpr void step() {
+    auto& j = job_;
+    if(!j.building) {
+      if(mem_.is_null(j.x) || mem_.is_null(j.y)) {
+        j.merged   = mem_.is_null(j.x) ? j.y : j.x;
+        j.building = true;
+        return;
+      }
+      if(less_(NodeU::peek(mem_, j.y), NodeU::peek(mem_, j.x)))
+        std::swap(j.x, j.y);
+      j.path.push_back(j.x);
+      j.x = mem_[j.x].right();
+    } else if(!j.path.empty()) {
+      Key const k = std::move(j.path.back());
+      j.path.pop_back();
+      j.merged = Node::make(mem_, mem_[k].elt(), mem_[k].left(), j.merged);
+    } else {
+      j.active = false;
+      add(j.merged);
+    }
+  }
+
+  constexpr void work() {
+    for(auto steps = budget_; steps > 0; --steps) {
+      if(!job_.active) {
+        if(parts_.size() < 2) return;
+        start();
+      }
+      step();
+    }
+  }
+
+ public:
+  using size_type = std::size_t;
+  constexpr explicit ScheduledHeap(std::size_t budget,
+                                   Mem         mem  = {},
+                                   Less        less = {})
+      : less_{std::move(less)}, mem_{std::move(mem)}, budget_{budget} {}
+
+  READER(less)
+  READER(mem)
+  READER(budget)
+
+  constexpr bool empty() const noexcept {
+    return parts_.empty() && !job_.active;
+  }
+  // parts not being merged, i.e. the work still to do
+  constexpr std::size_t parts() const noexcept { return parts_.size(); }
+
+  constexpr ReadReturn<T> peek() const noexcept(noex_assert) {
+    LEFTIST_HEAP_ASSERT(!empty());
+    if(!job_.active) return NodeU::peek(mem_, parts_.front());
+    auto const& k = job_least();
+    return parts_.empty() || !later(k, parts_.front())
+             ? NodeU::peek(mem_, k)
+             : NodeU::peek(mem_, parts_.front());
+  }
+
+  constexpr ScheduledHeap& cons(T e) {
+    add(Node::make1(mem_, std::move(e)));
+    work();
+    return *this;
+  }
+
+  constexpr ScheduledHeap& pop() {
+    LEFTIST_HEAP_ASSERT(!empty());
+    if(job_.active
+       && (parts_.empty() || !later(job_least(), parts_.front())))
+      cancel();
+    std::pop_heap(parts_.begin(), parts_.end(), [this](auto& p, auto& q) {
+      return later(p, q);
+    });
+    Key const top = std::move(parts_.back());
+    parts_.pop_back();
+    add(mem_[top].left());
+    add(mem_[top].right());
+    work();
+    return *this;
+  }
+
+  constexpr size_type size() const {
+    size_type n = 0;
+    for(auto const& k : parts_)
+      n += NodeU::template count<size_type>(mem_, k);
+    if(job_.active)
+      n += NodeU::template count<size_type>(mem_, job_.a)
+         + NodeU::template count<size_type>(mem_, job_.b);
+    return n;
+  }
+
+  // everything merged now, however long that takes
+  constexpr Heap<T, Less, Mem, Node> persistent() const {
+    Key root = job_.active ? Node::merge(mem_, less_, job_.a, job_.b)
+                           : mem_.null();
+    for(auto const& k : parts_) root = Node::merge(mem_, less_, root, k);
+    return Heap<T, Less, Mem, Node>::adopt(mem_, std::move(root), less_);
+  }
+};
+
+#endif // SCHEDULE_HPP_INCLUDE_GUARD
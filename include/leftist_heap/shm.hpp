@@ -0,0 +1,175 @@
+#ifndef SHM_HPP_INCLUDE_GUARD
+#define SHM_HPP_INCLUDE_GUARD
+
+#include "mmap.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+
+// Nodes in a POSIX shared memory segment, for heaps that several processes
+// read at once. As with mapped_file, keys are 1-based node offsets, so
+// they mean the same thing wherever the segment is mapped.
+//
+// Nodes are immutable, so once a root is published every process can
+// peek and pop its own versions of that heap without copying or locking.
+// Allocation is split into fixed-size sub-arenas: each attachment claims
+// whole arenas with one CAS and bumps through them privately. Claimed
+// arenas are never handed back, other processes may still be reading
+// their nodes.
+//
+// The segment has a fixed capacity, chosen when it is created.
+template<class T>
+class shared_segment {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "nodes are shared as raw bytes");
+  static_assert(alignof(T) <= 64);
+  static_assert(std::atomic<std::uint64_t>::is_always_lock_free);
+
+  struct header {
+    std::uint64_t              magic;
+    std::uint64_t              node_size;
+    std::uint64_t              arena_size;
+    std::uint64_t              arena_count;
+    std::atomic<std::uint64_t> published;
+  };
+  struct arena_slot {
+    std::atomic<std::uint32_t> claimed;
+  };
+  static constexpr std::uint64_t magic = 0x7061'6568'6d68'7366;
+
+  mapped_region region_;
+  std::size_t   arena_ = 0; // the arena we're bumping through
+  std::size_t   used_  = 0; // slots used in it
+  bool          owns_  = false;
+
+  static constexpr std::size_t round_up(std::size_t n) noexcept {
+    return (n + 63) / 64 * 64;
+  }
+
+  header& head() const noexcept {
+    return *reinterpret_cast<header*>(region_.data());
+  }
+  arena_slot* arenas() const noexcept {
+    return reinterpret_cast<arena_slot*>(region_.data()
+                                         + round_up(sizeof(header)));
+  }
+  static constexpr std::size_t nodes_offset(std::size_t arena_count) {
+    return round_up(sizeof(header))
+         + round_up(arena_count * sizeof(arena_slot));
+  }
+  T* nodes() const noexcept {
+    return reinterpret_cast<T*>(region_.data()
+                                + nodes_offset(head().arena_count));
+  }
+
+  explicit shared_segment(int fd) : region_{fd} {}
+
+  static int open_shm(char const* name, int flags) {
+    auto const fd = ::shm_open(name, flags, 0600);
+    if(fd < 0) throw_errno("shm_open");
+    return fd;
+  }
+
+  void claim_arena() {
+    for(std::size_t a = 0; a < head().arena_count; ++a) {
+      std::uint32_t expected = 0;
+      if(arenas()[a].claimed.compare_exchange_strong(expected, 1)) {
+        arena_ = a;
+        used_  = 0;
+        owns_  = true;
+        return;
+      }
+    }
+    throw std::bad_alloc{};
+  }
+
+ public:
+  using Key = std::uint64_t;
+
+  // capacity is rounded up to whole arenas
+  static shared_segment create(char const* name,
+                               std::size_t capacity,
+                               std::size_t arena_size) {
+    auto const fd = open_shm(name, O_RDWR | O_CREAT | O_EXCL);
+    // from here on the name is ours: don't leave it behind if we fail
+    try {
+      shared_segment seg{fd};
+      auto const     count = (capacity + arena_size - 1) / arena_size;
+      seg.region_.resize(nodes_offset(count)
+                         + count * arena_size * sizeof(T));
+      auto& h = *std::construct_at(
+          reinterpret_cast<header*>(seg.region_.data()));
+      h.magic       = magic;
+      h.node_size   = sizeof(T);
+      h.arena_size  = arena_size;
+      h.arena_count = count;
+      for(std::size_t a = 0; a < count; ++a)
+        std::construct_at(&seg.arenas()[a])->claimed.store(0);
+      h.published.store(0, std::memory_order_release);
+      return seg;
+    } catch(...) {
+      ::shm_unlink(name);
+      throw;
+    }
+  }
+
+  static shared_segment attach(char const* name) {
+    shared_segment seg{open_shm(name, O_RDWR)};
+    if(seg.region_.size() < sizeof(header) || seg.head().magic != magic
+       || seg.head().node_size != sizeof(T))
+      throw std::runtime_error{"not a heap segment for this node type"};
+    return seg;
+  }
+
+  // the segment lives on until every process unmaps it
+  static void remove(char const* name) {
+    if(::shm_unlink(name) != 0) throw_errno("shm_unlink");
+  }
+
+  T const& operator[](Key i) const
+      noexcept(LEFTIST_HEAP_ASSERT_NOEXCEPT) {
+    LEFTIST_HEAP_ASSERT(0 < i
+                        && i <= head().arena_count * head().arena_size);
+    return nodes()[i - 1];
+  }
+
+  Key make(auto&&... args) {
+    if(!owns_ || used_ == head().arena_size) claim_arena();
+    auto const j = arena_ * head().arena_size + used_;
+    std::construct_at(nodes() + j, FWD(args)...);
+    ++used_;
+    return j + 1;
+  }
+
+  // Release/acquire: a process that sees a published root also sees all
+  // of the nodes under it.
+  void publish(Key root) noexcept {
+    head().published.store(root, std::memory_order_release);
+  }
+  Key published() const noexcept {
+    return head().published.load(std::memory_order_acquire);
+  }
+};
+
+template<class T>
+struct shm_mem {
+  using Key = typename shared_segment<T>::Key;
+  shared_segment<T>* segment;
+
+  T const& operator[](Key i) const NOEX((*segment)[i])
+
+  constexpr Key  null() const noexcept { return 0; }
+  constexpr bool is_null(Key i) const noexcept { return i == 0; }
+
+  Key make_key(auto&&... args) NOEX(segment->make(FWD(args)...))
+};
+
+#endif // SHM_HPP_INCLUDE_GUARD
@@ -0,0 +1,92 @@
+#ifndef SKEW_HPP_INCLUDE_GUARD
+#define SKEW_HPP_INCLUDE_GUARD
+
+#include "heap.hpp"
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+// A skew heap: a leftist heap that doesn't keep ranks and just swaps the
+// children of every node on the merge path instead. Nodes lose the rank
+// byte (and its padding), and merge loses the rank compares.
+//
+// Caveat: the O(log n) bounds are amortized, and the amortization assumes
+// each version is used once. A persistent heap can pop the same expensive
+// version over and over, and each of those pops walks the same long right
+// spine: O(n) per operation in the worst case. Node and WeightNode don't
+// have this problem.
+template<class T, class key>
+class SkewNode {
+ public:
+  using element_t = T;
+  using Key       = key;
+
+ private:
+  // clang-format off
+  enum                    { elt_i, left_i, right_i };
+  size_sorted_tuple<T    , Key   , Key    > data_;
+  // clang-format on
+
+  struct permission2construct {
+    friend SkewNode;
+
+   private:
+    permission2construct() = default;
+  };
+
+ public:
+  SkewNode() = default;
+  SkewNode(permission2construct, T elt, Key left, Key right)
+      : data_{std::move(elt), std::move(left), std::move(right)} {}
+
+  READER(elt, data_.template get<elt_i>())
+  READER(left, data_.template get<left_i>())
+  READER(right, data_.template get<right_i>())
+
+  // there's no shape to keep, the children go where they're put
+  constexpr static Key make(auto mem, T e, Read<Key> left, Read<Key> right)
+      NOEX(mem.template make_key(
+          permission2construct{}, std::move(e), left, right))
+
+  constexpr static auto make1(auto mem, auto e)
+      ARROW(make(mem, std::move(e), mem.null(), mem.null()))
+
+  constexpr static Key
+      relink(auto mem, SkewNode const& n, Read<Key> left, Read<Key> right)
+          NOEX(make(mem, n.elt(), left, right))
+
+  // As Node::merge, but the merged spine always goes on the left. A right
+  // spine is only short amortized, so the path can outgrow the array.
+  constexpr static Key
+      merge(auto mem, auto less, Read<Key> node1, Read<Key> node2) {
+    std::array<key_ref<Key>, 2 * std::numeric_limits<std::uintptr_t>::digits>
+                              path;
+    std::vector<key_ref<Key>> more;
+    std::size_t               depth = 0;
+    auto const at = [&](std::size_t i) -> key_ref<Key>& {
+      return i < path.size() ? path[i] : more[i - path.size()];
+    };
+
+    key_ref<Key> a = node1, b = node2;
+    while(!mem.is_null(a.get()) && !mem.is_null(b.get())) {
+      if(less(mem[b.get()].elt(), mem[a.get()].elt())) std::swap(a, b);
+      if(depth < path.size()) path[depth] = a;
+      else more.push_back(a);
+      ++depth;
+      a = mem[a.get()].right();
+    }
+
+    Key merged = mem.is_null(a.get()) ? b.get() : a.get();
+    [[maybe_unused]] auto const reserved = reserve_keys(mem, depth);
+    while(depth > 0) {
+      auto const& n = mem[at(--depth).get()];
+      merged        = make(mem, n.elt(), merged, n.left());
+    }
+    return merged;
+  }
+};
+
+static_assert(sizeof(SkewNode<int, std::uint32_t>) == 12);
+
+#endif // SKEW_HPP_INCLUDE_GUARD
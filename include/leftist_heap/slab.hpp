@@ -0,0 +1,213 @@
+#ifndef SLAB_HPP_INCLUDE_GUARD
+#define SLAB_HPP_INCLUDE_GUARD
+
+#include "heap.hpp"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+// Refcounted nodes without shared_ptr: a key is a bare slab index, and the
+// count lives in the node's slot. Freed slots go on a free list.
+//
+// plain counts are for heaps that never cross threads, atomic counts make
+// copying and dropping keys thread safe.
+enum class refcount { plain, atomic };
+
+// One slab per node type, alive for the whole program. Slots live in
+// chunks that double in size, so they never move and a 32 bit index needs
+// at most 32 chunks.
+template<class T, class Index, refcount R, std::size_t FirstChunk = 256>
+class rc_slab {
+  static constexpr bool is_atomic = R == refcount::atomic;
+  using count = std::conditional_t<is_atomic, std::atomic<Index>, Index>;
+
+  struct slot {
+    union {
+      T value;
+    };
+    // while the slot is dead, this links the free and pending lists
+    count refs;
+
+    slot() noexcept {}
+    ~slot() {}
+  };
+
+  struct no_lock {
+    void lock() noexcept {}
+    void unlock() noexcept {}
+  };
+  using lock = std::conditional_t<is_atomic, std::mutex, no_lock>;
+
+  static constexpr std::size_t max_chunks =
+      std::numeric_limits<Index>::digits;
+
+  std::array<std::atomic<slot*>, max_chunks> chunks_{};
+  std::size_t                                used_ = 0;
+  Index                                      free_ = 0;
+  [[no_unique_address]] lock                 lock_;
+
+  rc_slab() = default;
+
+  static constexpr std::size_t chunk_of(std::size_t j) noexcept {
+    return static_cast<std::size_t>(std::bit_width(j / FirstChunk + 1))
+         - 1;
+  }
+  static constexpr std::size_t chunk_start(std::size_t c) noexcept {
+    return FirstChunk * ((std::size_t{1} << c) - 1);
+  }
+
+  // 1-based, like the keys
+  slot& at(Index i) const noexcept(LEFTIST_HEAP_ASSERT_NOEXCEPT) {
+    LEFTIST_HEAP_ASSERT(0 < i);
+    std::size_t const j     = i - std::size_t{1};
+    auto const        c     = chunk_of(j);
+    auto const        chunk = chunks_[c].load(std::memory_order_relaxed);
+    return chunk[j - chunk_start(c)];
+  }
+
+  Index take_slot() {
+    std::scoped_lock _{lock_};
+    if(free_ != 0) {
+      auto const i = free_;
+      free_        = at(i).refs;
+      return i;
+    }
+    auto const j = used_;
+    auto const c = chunk_of(j);
+    if(j == chunk_start(c))
+      chunks_[c].store(std::allocator<slot>{}.allocate(FirstChunk << c),
+                       std::memory_order_release);
+    auto const i = narrow<Index>(++used_);
+    std::construct_at(&at(i));
+    return i;
+  }
+
+  void free_slot(Index i) noexcept {
+    std::scoped_lock _{lock_};
+    at(i).refs = free_;
+    free_      = i;
+  }
+
+ public:
+  rc_slab(rc_slab const&) = delete;
+
+  static rc_slab& instance() {
+    // never destroyed, so keys in other statics stay safe to drop
+    static auto& slab = *new rc_slab;
+    return slab;
+  }
+
+  // slots ever handed out, live or free
+  std::size_t high_water() const noexcept { return used_; }
+
+  T const& operator[](Index i) const NOEX(at(i).value)
+
+  Index make(auto&&... args) {
+    auto const i = take_slot();
+    try {
+      std::construct_at(&at(i).value, FWD(args)...);
+    } catch(...) {
+      free_slot(i);
+      throw;
+    }
+    if constexpr(is_atomic) at(i).refs.store(1, std::memory_order_relaxed);
+    else at(i).refs = 1;
+    return i;
+  }
+
+  void retain(Index i) noexcept {
+    if constexpr(is_atomic)
+      at(i).refs.fetch_add(1, std::memory_order_relaxed);
+    else ++at(i).refs;
+  }
+
+  void release(Index i) noexcept {
+    if constexpr(is_atomic) {
+      if(at(i).refs.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+    } else {
+      if(--at(i).refs != 0) return;
+    }
+    // Destroying a node drops its children's keys. Collect them on a
+    // pending list instead of recursing, long spines would blow the stack.
+    thread_local Index pending  = 0;
+    thread_local bool  draining = false;
+    at(i).refs                  = pending;
+    pending                     = i;
+    if(draining) return;
+    draining = true;
+    while(pending != 0) {
+      auto const j = pending;
+      pending      = at(j).refs;
+      std::destroy_at(&at(j).value);
+      free_slot(j);
+    }
+    draining = false;
+  }
+};
+
+// Tag::type must be the node type, which is how the key finds its slab
+// without the node type depending on itself:
+//
+//   struct tag;
+//   using node = Node<int, slab_key<tag>>;
+//   struct tag { using type = node; };
+template<class Tag,
+         class Index = std::uint32_t,
+         refcount R  = refcount::plain>
+class slab_key {
+  Index i_ = 0;
+
+  explicit slab_key(Index i) noexcept : i_{i} {}
+
+ public:
+  static constexpr bool thread_safe = R == refcount::atomic;
+
+  static auto& slab() {
+    return rc_slab<typename Tag::type, Index, R>::instance();
+  }
+
+  // the new key holds the only reference to the node
+  static auto make(auto&&... args)
+      ARROW(slab_key{slab().make(FWD(args)...)})
+
+  slab_key() = default;
+  slab_key(slab_key const& other) noexcept : i_{other.i_} {
+    if(i_ != 0) slab().retain(i_);
+  }
+  slab_key(slab_key&& other) noexcept : i_{std::exchange(other.i_, 0)} {}
+  slab_key& operator=(slab_key other) noexcept {
+    std::swap(i_, other.i_);
+    return *this;
+  }
+  ~slab_key() {
+    if(i_ != 0) slab().release(i_);
+  }
+
+  Index index() const noexcept { return i_; }
+
+  friend bool operator==(slab_key const&, slab_key const&) = default;
+};
+
+template<class T>
+struct slab_mem {
+  using Key = typename T::Key;
+  static constexpr bool thread_safe = Key::thread_safe;
+
+  T const& operator[](Key const& i) const
+      noexcept(LEFTIST_HEAP_ASSERT_NOEXCEPT) {
+    LEFTIST_HEAP_ASSERT(!is_null(i));
+    return Key::slab()[i.index()];
+  }
+
+  Key  null() const noexcept { return {}; }
+  bool is_null(Key const& i) const noexcept { return i.index() == 0; }
+  auto make_key(auto&&... args) ARROW(Key::make(FWD(args)...))
+};
+
+#endif // SLAB_HPP_INCLUDE_GUARD
@@ -0,0 +1,114 @@
+#ifndef SOA_HPP_INCLUDE_GUARD
+#define SOA_HPP_INCLUDE_GUARD
+
+#include "heap.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Nodes stored as a struct of arrays. merge compares elements far more
+// often than it follows links, so the elements get an array to themselves.
+template<class T, class Key = std::uint32_t, class Rank = std::uint8_t>
+struct soa_block {
+  std::vector<T>    elts;
+  std::vector<Key>  lefts;
+  std::vector<Key>  rights;
+  std::vector<Rank> ranks;
+
+  std::size_t size() const noexcept { return elts.size(); }
+
+  // room for one more node in every array, so that adding it can't fail
+  // halfway and leave the arrays different lengths
+  void reserve_one() {
+    auto const cap = std::max<std::size_t>(2 * size(), 16);
+    if(elts.size() == elts.capacity()) elts.reserve(cap);
+    if(lefts.size() == lefts.capacity()) lefts.reserve(cap);
+    if(rights.size() == rights.capacity()) rights.reserve(cap);
+    if(ranks.size() == ranks.capacity()) ranks.reserve(cap);
+  }
+};
+
+// What mem[key] gives you instead of a Node&.
+template<class T, class Key, class Rank>
+class soa_ref {
+  soa_block<T, Key, Rank> const* block_;
+  std::size_t                    i_;
+
+ public:
+  constexpr soa_ref(soa_block<T, Key, Rank> const* block, std::size_t i)
+      : block_{block}, i_{i} {}
+
+  constexpr ReadReturn<T> elt() const NOEX(block_->elts[i_])
+  constexpr Key           left() const NOEX(block_->lefts[i_])
+  constexpr Key           right() const NOEX(block_->rights[i_])
+  constexpr Rank          rank() const NOEX(block_->ranks[i_])
+};
+
+template<class T, class Key_ = std::uint32_t, class Rank = std::uint8_t>
+struct soa_mem {
+  using Key = Key_;
+  soa_block<T, Key, Rank>* block;
+
+  constexpr soa_ref<T, Key, Rank> operator[](Key i) const
+      noexcept(LEFTIST_HEAP_ASSERT_NOEXCEPT) {
+    LEFTIST_HEAP_ASSERT(!is_null(i));
+    LEFTIST_HEAP_ASSERT(i <= block->size());
+    return {block, i - std::size_t{1}};
+  }
+
+  constexpr Key  null() const noexcept { return 0; }
+  constexpr bool is_null(Read<Key> i) const noexcept { return i == 0; }
+
+  constexpr Key make_key(T e, Key left, Key right, Rank rank) {
+    block->reserve_one();
+    // only this one can throw now, and then nothing's been added
+    block->elts.push_back(std::move(e));
+    block->lefts.push_back(left);
+    block->rights.push_back(right);
+    block->ranks.push_back(rank);
+    return narrow<Key>(block->size());
+  }
+};
+
+// Node for a soa_mem. It's Node's algorithm again: the node can't own its
+// fields when they live in different arrays.
+template<class T, class key = std::uint32_t, class Rank = std::uint8_t>
+class SoaNode {
+ public:
+  using element_t = T;
+  using Key       = key;
+
+ private:
+  constexpr static Rank rank_of(auto const mem, Read<Key> n)
+      NOEX(mem.is_null(n) ? Rank{} : mem[n].rank())
+
+ public:
+  constexpr static Key make(auto mem, T e, Read<Key> node1, Read<Key> node2) {
+    auto const& [r, l] =
+        std::minmax(node1, node2, cmp_by([=] FN(rank_of(mem, _))));
+    return mem.make_key(
+        std::move(e), l, r, narrow<Rank>(rank_of(mem, r) + 1));
+  }
+
+  constexpr static auto make1(auto mem, auto e)
+      ARROW(make(mem, std::move(e), mem.null(), mem.null()))
+
+  constexpr static Key
+      merge(auto mem, auto less, Read<Key> node1, Read<Key> node2) {
+    return mem.is_null(node1) ? node2
+         : mem.is_null(node2) ? node1
+         : less(mem[node2].elt(), mem[node1].elt())
+             ? make(mem,
+                    mem[node2].elt(),
+                    mem[node2].left(),
+                    merge(mem, less, node1, mem[node2].right()))
+             : make(mem,
+                    mem[node1].elt(),
+                    mem[node1].left(),
+                    merge(mem, less, node2, mem[node1].right()));
+  }
+};
+
+#endif // SOA_HPP_INCLUDE_GUARD
@@ -18,14 +18,17 @@ struct say_v;
 #include <array>
 #include <numeric>
 #include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
 
-template<size_t N>
-using permutation = std::array<size_t, N>;
+template<std::size_t N>
+using permutation = std::array<std::size_t, N>;
 
-template<size_t N>
+template<std::size_t N>
 constexpr permutation<N> invert(permutation<N> permutation) {
-  std::array<size_t, N> inv;
-  for(size_t i = 0; i < N; ++i) inv[permutation[i]] = i;
+  std::array<std::size_t, N> inv;
+  for(std::size_t i = 0; i < N; ++i) inv[permutation[i]] = i;
   return inv;
 }
 
@@ -49,16 +52,21 @@ class arg_list_sorter {
  private:
   using unsorted_tuple = std::tuple<Args...>;
   static constexpr std::array sizes{sizeof(Args)...};
+  static constexpr std::array aligns{alignof(Args)...};
 
   static constexpr auto count = sizeof...(Args);
 
  public:
+  // Biggest alignment first: every size is a multiple of its alignment,
+  // so each field then starts aligned and the only padding is at the end.
+  // Ties go by size, then keep their order.
   static constexpr std::array sort2ext_indices = [] {
-    std::array<size_t, count> inds;
+    std::array<std::size_t, count> inds;
     std::iota(std::begin(inds), std::end(inds), 0);
-    std::sort(std::begin(inds),
-              std::end(inds),
-              cmp_by([] FN(sizes[_]), std::greater<> {}));
+    std::sort(std::begin(inds), std::end(inds), [](auto i, auto j) {
+      return std::tuple{aligns[j], sizes[j], i}
+           < std::tuple{aligns[i], sizes[i], j};
+    });
     return inds;
   }();
 
@@ -75,27 +83,81 @@ static_assert(
         std::tuple_element_t<0, arg_list_sorter<int, char>::sorted_tuple>,
         int>);
 
+// The smallest a struct of Ts can be: no padding but at the end.
+template<class... Ts>
+constexpr std::size_t tight_size = [] {
+  constexpr auto align = std::max({alignof(Ts)...});
+  return ((sizeof(Ts) + ...) + align - 1) / align * align;
+}();
+
+template<std::size_t I, class T>
+struct tuple_leaf {
+  T value;
+};
+
+// Unlike std::tuple, which lays its elements out in whatever order it
+// likes and isn't trivially copyable, this stores Ts in size order, in
+// plain base classes.
 template<class... Ts>
 class size_sorted_tuple {
   using sorter = arg_list_sorter<Ts...>;
-  typename sorter::sorted_tuple underlying_;
+  template<std::size_t n>
+  using type = std::tuple_element_t<n, std::tuple<Ts...>>;
+  template<std::size_t n>
+  using leaf = tuple_leaf<sorter::ext2sort_indices[n], type<n>>;
+
+  template<class>
+  struct storage;
+  template<std::size_t... Is>
+  struct storage<std::index_sequence<Is...>>
+      : tuple_leaf<Is, type<sorter::sort2ext_indices[Is]>>... {};
+
+  storage<std::index_sequence_for<Ts...>> underlying_;
+
+  template<class T>
+  static constexpr std::size_t index_of = [] {
+    constexpr std::array matches{std::is_same_v<T, Ts>...};
+    static_assert(std::count(matches.begin(), matches.end(), true) == 1,
+                  "get<T> needs exactly one field of type T");
+    return static_cast<std::size_t>(
+        std::find(matches.begin(), matches.end(), true) - matches.begin());
+  }();
+
+  template<std::size_t... Is>
+  constexpr size_sorted_tuple(std::index_sequence<Is...>, auto&& args)
+      : underlying_{{std::get<sorter::sort2ext_indices[Is]>(
+          std::move(args))}...} {}
 
  public:
-  // do I need to overload on const myself?
   template<auto n>
-  constexpr auto get()
-      ARROW(std::get<sorter::ext2sort_indices[n]>(underlying_))
+  constexpr auto& get() noexcept {
+    return static_cast<leaf<n>&>(underlying_).value;
+  }
+  template<auto n>
+  constexpr auto const& get() const noexcept {
+    return static_cast<leaf<n> const&>(underlying_).value;
+  }
+  template<class T>
+  constexpr auto get() ARROW(get<index_of<T>>())
   template<class T>
-  constexpr auto get() ARROW(std::get<T>(underlying_))
+  constexpr auto get() const ARROW(get<index_of<T>>())
 
   constexpr static auto size = sizeof...(Ts);
 
-  constexpr size_sorted_tuple(std::tuple<Ts...> args)
-      : underlying_{sorter::sort(args)} {}
+  size_sorted_tuple() = default;
 
-  constexpr size_sorted_tuple(Ts const&... args)
-      : size_sorted_tuple(std::tuple{args...}) {}
+  // each argument goes straight into its field, in the given order
+  template<class... Us>
+  requires(sizeof...(Us) == sizeof...(Ts)
+           && (std::is_constructible_v<Ts, Us&&> && ...))
+  constexpr size_sorted_tuple(Us&&... args)
+      : size_sorted_tuple(std::index_sequence_for<Ts...>{},
+                          std::forward_as_tuple(FWD(args)...)) {}
 };
+static_assert(sizeof(size_sorted_tuple<char, int, char>)
+              == tight_size<char, int, char>);
+static_assert(
+    std::is_trivially_copyable_v<size_sorted_tuple<char, int, char>>);
 
 template<class... Ts>
 struct std::tuple_size<size_sorted_tuple<Ts...>>
@@ -0,0 +1,511 @@
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+
+#include <leftist_heap/heap.hpp>
+#include <leftist_heap/arena.hpp>
+#include <leftist_heap/compact.hpp>
+#include <leftist_heap/soa.hpp>
+#include <leftist_heap/block.hpp>
+#include <leftist_heap/skew.hpp>
+#include <leftist_heap/pairing.hpp>
+#include <leftist_heap/bootstrap.hpp>
+#include <leftist_heap/lazy.hpp>
+#include <leftist_heap/schedule.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+
+// LEFTIST_HEAP_BENCH_SIZE overrides the number of elements,
+// e.g. LEFTIST_HEAP_BENCH_SIZE=100000000 for the big runs
+static std::size_t bench_size() {
+  auto const env = std::getenv("LEFTIST_HEAP_BENCH_SIZE");
+  return env ? std::stoull(env) : std::size_t{1} << 20;
+}
+
+static std::vector<int> random_ints(std::size_t n) {
+  std::mt19937                       gen{42};
+  std::uniform_int_distribution<int> dist;
+  std::vector<int>                   out(n);
+  for(auto& x : out) x = dist(gen);
+  return out;
+}
+
+TEST_CASE("pop throughput by node layout", "[layout]") {
+  using node    = Node<int, std::size_t>;
+  using VecHeap = Heap<int, std::less<>, vector_mem<node>, node>;
+  constexpr int pops = 1000;
+
+  std::vector<node> block{};
+  auto const        n = bench_size();
+  auto const        h = into(VecHeap{{&block}}, random_ints(n));
+
+  for(auto const& [name, order] :
+      {std::pair{"as built", std::optional<layout>{}},
+       std::pair{"left spine", std::optional{layout::left_spine}},
+       std::pair{"right spine", std::optional{layout::right_spine}},
+       std::pair{"breadth first", std::optional{layout::breadth_first}}}) {
+    std::vector<node> fresh{};
+    auto&             used = order ? fresh : block;
+    auto const moved = order ? compact(std::array{h}, &fresh, *order)[0] : h;
+    auto const live  = used.size();
+
+    BENCHMARK(std::string{name} + ", n = " + std::to_string(n)) {
+      auto x = moved;
+      for(int i = 0; i < pops; ++i) x = x.pop();
+      used.erase(used.begin() + static_cast<std::ptrdiff_t>(live),
+                 used.end());
+      return x.empty();
+    };
+  }
+}
+
+struct payload32 {
+  std::int64_t         key;
+  std::array<char, 24> rest;
+
+  friend bool operator<(payload32 const& a, payload32 const& b) noexcept {
+    return a.key < b.key;
+  }
+};
+static_assert(sizeof(payload32) == 32);
+
+template<class T>
+static std::vector<T> random_values(std::size_t n) {
+  std::vector<T> out;
+  for(auto const x : random_ints(n)) {
+    if constexpr(std::is_same_v<T, payload32>) out.push_back({x, {}});
+    else out.push_back(static_cast<T>(x));
+  }
+  return out;
+}
+
+template<class T>
+static void bench_aos_vs_soa(std::string const& type) {
+  constexpr int pops = 1000;
+  auto const    n    = bench_size();
+  auto const    data = random_values<T>(n);
+  auto const    tag  = type + ", n = " + std::to_string(n);
+
+  {
+    using node    = Node<T, std::uint32_t>;
+    using mem     = vector_mem<node, std::vector<node>, std::uint32_t>;
+    using AosHeap = Heap<T, std::less<>, mem, node>;
+
+    std::vector<node> block{};
+    auto const        h    = into(AosHeap{{&block}}, data);
+    auto const        live = block.size();
+    BENCHMARK("AoS " + tag) {
+      auto x = h;
+      for(int i = 0; i < pops; ++i) x = x.pop();
+      block.resize(live);
+      return x.empty();
+    };
+  }
+  {
+    using SoaHeap = Heap<T, std::less<>, soa_mem<T>, SoaNode<T>>;
+
+    soa_block<T> block{};
+    auto const   h    = into(SoaHeap{{&block}}, data);
+    auto const   live = block.size();
+    BENCHMARK("SoA " + tag) {
+      auto x = h;
+      for(int i = 0; i < pops; ++i) x = x.pop();
+      block.elts.resize(live);
+      block.lefts.resize(live);
+      block.rights.resize(live);
+      block.ranks.resize(live);
+      return x.empty();
+    };
+  }
+}
+
+TEST_CASE("pop throughput, array of structs vs struct of arrays", "[soa]") {
+  bench_aos_vs_soa<int>("int");
+  bench_aos_vs_soa<double>("double");
+  bench_aos_vs_soa<payload32>("32 byte payload");
+}
+
+template<class node>
+static void bench_nodes(std::string const& name) {
+  using mem     = vector_mem<node, std::vector<node>, std::uint32_t>;
+  using VecHeap = Heap<int, std::less<>, mem, node>;
+  constexpr int pops = 1000;
+  auto const    n    = bench_size();
+  auto const    data = random_ints(n);
+
+  std::vector<node> block{};
+  BENCHMARK(name + ", " + std::to_string(pops) + " conses") {
+    auto const live = block.size();
+    auto       x    = VecHeap{{&block}};
+    for(int i = 0; i < pops; ++i)
+      x = x.cons(data[static_cast<std::size_t>(i)]);
+    block.resize(live);
+    return x.empty();
+  };
+
+  auto const h    = into(VecHeap{{&block}}, data);
+  auto const live = block.size();
+  BENCHMARK(name + ", " + std::to_string(pops) + " pops, n = "
+            + std::to_string(n)) {
+    auto x = h;
+    for(int i = 0; i < pops; ++i) x = x.pop();
+    block.resize(live);
+    return x.empty();
+  };
+}
+
+TEST_CASE("Node vs BlockNode by block size", "[block]") {
+  bench_nodes<Node<int, std::uint32_t>>("Node");
+  bench_nodes<BlockNode<int, std::uint32_t, 2>>("BlockNode, B = 2");
+  bench_nodes<BlockNode<int, std::uint32_t, 4>>("BlockNode, B = 4");
+  bench_nodes<BlockNode<int, std::uint32_t, 8>>("BlockNode, B = 8");
+  bench_nodes<BlockNode<int, std::uint32_t, 16>>("BlockNode, B = 16");
+  bench_nodes<BlockNode<int, std::uint32_t, 32>>("BlockNode, B = 32");
+}
+
+TEST_CASE("rank-biased vs weight-biased nodes", "[weight]") {
+  bench_nodes<Node<int, std::uint32_t>>("Node");
+  bench_nodes<WeightNode<int, std::uint32_t, std::uint32_t>>("WeightNode");
+}
+
+TEST_CASE("rank-biased vs weight-biased vs skew nodes", "[skew]") {
+  bench_nodes<Node<int, std::uint32_t>>("Node");
+  bench_nodes<WeightNode<int, std::uint32_t, std::uint32_t>>("WeightNode");
+  bench_nodes<SkewNode<int, std::uint32_t>>("SkewNode");
+}
+
+template<class node, class Mem>
+static void bench_pop_all(std::string const& name, Mem mem, std::size_t n) {
+  using H = Heap<int, std::less<>, Mem, node>;
+  auto const h = into(H{mem}, random_ints(n));
+  std::size_t live = 0;
+  if constexpr(requires { mem.block; }) live = mem.block->size();
+  BENCHMARK(name + ", pop everything, n = " + std::to_string(n)) {
+    auto x = h;
+    while(!x.empty()) x = x.pop();
+    if constexpr(requires { mem.block; }) mem.block->resize(live);
+    return x.empty();
+  };
+}
+
+TEST_CASE("pop-heavy workloads", "[merge]") {
+  using vec_node = Node<int, std::size_t>;
+  using ptr_node = Node<int, std::shared_ptr<void>>;
+  for(auto const n : {std::size_t{1} << 10, bench_size() / 64}) {
+    std::vector<vec_node> block{};
+    bench_pop_all<vec_node>("vector_mem", vector_mem<vec_node>{&block}, n);
+    bench_pop_all<ptr_node>("shared_ptr_mem", shared_ptr_mem<ptr_node>{}, n);
+  }
+}
+
+TEST_CASE("building a heap: cons one by one vs from_range", "[build]") {
+  using node    = Node<int, std::size_t>;
+  using VecHeap = Heap<int, std::less<>, vector_mem<node>, node>;
+  auto const n    = bench_size();
+  auto const data = random_ints(n);
+  auto const tag  = ", n = " + std::to_string(n);
+
+  std::vector<node> block{};
+  BENCHMARK("into" + tag) {
+    block.clear();
+    return into(VecHeap{{&block}}, data).empty();
+  };
+  BENCHMARK("from_range" + tag) {
+    block.clear();
+    return VecHeap::from_range({&block}, {}, data).empty();
+  };
+}
+
+TEST_CASE("parallel from_range by thread count", "[parallel]") {
+  using node    = Node<int, std::shared_ptr<void>>;
+  using PtrHeap = Heap<int, std::less<>, shared_ptr_mem<node>, node>;
+  auto const n    = bench_size();
+  auto const data = random_ints(n);
+
+  // past the core count too, to see what splitting costs by itself
+  auto const cores = std::max(4u, std::thread::hardware_concurrency());
+  for(unsigned threads = 1; threads <= cores; threads *= 2)
+    BENCHMARK(std::to_string(threads) + " threads, n = " + std::to_string(n)) {
+      return PtrHeap::from_range({}, {}, data, threads).empty();
+    };
+
+  using arena_node = Node<int, void const*>;
+  using ArenaHeap =
+      Heap<int, std::less<>, arena_mem<arena_node>, arena_node>;
+  for(unsigned threads = 1; threads <= cores; threads *= 2) {
+    std::vector<arena<arena_node>>     arenas(threads);
+    std::vector<arena_mem<arena_node>> mems;
+    for(auto& a : arenas) mems.push_back({&a});
+    BENCHMARK(std::to_string(threads) + " arenas, n = " + std::to_string(n)) {
+      for(auto& a : arenas) a.reset();
+      return ArenaHeap::from_range_in(mems, {}, data).empty();
+    };
+  }
+}
+
+template<class node, class Mem>
+static void bench_transient(std::string const& name, Mem mem, std::size_t n) {
+  using H          = Heap<int, std::less<>, Mem, node>;
+  auto const data  = random_ints(n);
+  auto const tag   = ", n = " + std::to_string(n);
+  auto const reset = [&] {
+    if constexpr(requires { mem.block; }) mem.block->clear();
+  };
+
+  BENCHMARK(name + ", cons everything, persistent" + tag) {
+    reset();
+    return into(H{mem}, data).empty();
+  };
+  BENCHMARK(name + ", cons everything, transient" + tag) {
+    reset();
+    auto t = H{mem}.transient();
+    for(auto const x : data) t.cons(x);
+    return t.empty();
+  };
+
+  BENCHMARK(name + ", cons then pop everything, persistent" + tag) {
+    reset();
+    auto h = into(H{mem}, data);
+    while(!h.empty()) h = h.pop();
+    return h.empty();
+  };
+  BENCHMARK(name + ", cons then pop everything, transient" + tag) {
+    reset();
+    auto t = H{mem}.transient();
+    for(auto const x : data) t.cons(x);
+    while(!t.empty()) t.pop();
+    return t.empty();
+  };
+}
+
+TEST_CASE("transient vs persistent batches", "[transient]") {
+  using vec_node = Node<int, std::size_t>;
+  using ptr_node = Node<int, std::shared_ptr<void>>;
+  auto const            n = bench_size() / 16;
+  std::vector<vec_node> block{};
+  bench_transient<vec_node>("vector_mem", vector_mem<vec_node>{&block}, n);
+  bench_transient<ptr_node>("shared_ptr_mem", shared_ptr_mem<ptr_node>{}, n);
+}
+
+TEST_CASE("popping copies vs popping rvalues", "[rvalue]") {
+  using node    = Node<int, std::shared_ptr<void>>;
+  using PtrHeap = Heap<int, std::less<>, shared_ptr_mem<node>, node>;
+  auto const n    = bench_size() / 16;
+  auto const data = random_ints(n);
+  auto const tag  = ", n = " + std::to_string(n);
+
+  BENCHMARK_ADVANCED("h = h.pop()" + tag)
+  (Catch::Benchmark::Chronometer meter) {
+    std::vector<PtrHeap> heaps;
+    for(int i = 0; i < meter.runs(); ++i)
+      heaps.push_back(PtrHeap::from_range({}, {}, data));
+    meter.measure([&](int i) {
+      auto& h = heaps[static_cast<std::size_t>(i)];
+      while(!h.empty()) h = h.pop();
+      return h.empty();
+    });
+  };
+  BENCHMARK_ADVANCED("h = std::move(h).pop()" + tag)
+  (Catch::Benchmark::Chronometer meter) {
+    std::vector<PtrHeap> heaps;
+    for(int i = 0; i < meter.runs(); ++i)
+      heaps.push_back(PtrHeap::from_range({}, {}, data));
+    meter.measure([&](int i) {
+      auto& h = heaps[static_cast<std::size_t>(i)];
+      while(!h.empty()) h = std::move(h).pop();
+      return h.empty();
+    });
+  };
+}
+
+// Every version is used once, as in Dijkstra's algorithm.
+template<class node>
+static void bench_mixes(std::string const& name) {
+  using mem     = vector_mem<node, std::vector<node>, std::uint32_t>;
+  using VecHeap = Heap<int, std::less<>, mem, node>;
+  auto const n    = bench_size() / 16;
+  auto const data = random_ints(n);
+  auto const tag  = ", n = " + std::to_string(n);
+
+  std::vector<node> block{};
+  BENCHMARK(name + ", 4 conses per pop" + tag) {
+    block.clear();
+    auto x = VecHeap{{&block}};
+    for(std::size_t i = 0; i < n; ++i) {
+      x = x.cons(data[i]);
+      if(i % 4 == 3) x = x.pop();
+    }
+    return x.empty();
+  };
+  BENCHMARK(name + ", cons everything then pop everything" + tag) {
+    block.clear();
+    auto x = into(VecHeap{{&block}}, data);
+    while(!x.empty()) x = x.pop();
+    return x.empty();
+  };
+}
+
+TEST_CASE("leftist vs pairing heaps", "[pairing]") {
+  bench_mixes<Node<int, std::uint32_t>>("Node");
+  bench_mixes<PairingNode<int, std::uint32_t>>("PairingNode");
+}
+
+template<class H>
+static void bench_melds(std::string const& name, H const empty) {
+  constexpr std::size_t queues = 4096, each = 16;
+  auto const            data   = random_ints(queues * each);
+  std::vector<H>        parts(queues, empty);
+  for(std::size_t i = 0; i < data.size(); ++i)
+    parts[i % queues] = parts[i % queues].cons(data[i]);
+
+  BENCHMARK(name + ", merge " + std::to_string(queues) + " queues of "
+            + std::to_string(each)) {
+    auto all = empty;
+    for(auto const& p : parts) all = all.merge(p);
+    return all.empty();
+  };
+  BENCHMARK(name + ", merge them, then pop 1000") {
+    auto all = empty;
+    for(auto const& p : parts) all = all.merge(p);
+    for(int i = 0; i < 1000; ++i) all = all.pop();
+    return all.empty();
+  };
+}
+
+TEST_CASE("leftist vs bootstrapped merges", "[bootstrap]") {
+  using node      = Node<int, std::shared_ptr<void>>;
+  using boot_node = PairingNode<boot_elt<int, std::shared_ptr<void>>,
+                                std::shared_ptr<void>>;
+  bench_melds("Heap<Node>",
+              Heap<int, std::less<>, shared_ptr_mem<node>, node>{});
+  bench_melds("BootstrappedHeap<PairingNode>",
+              BootstrappedHeap<int,
+                               std::less<>,
+                               shared_ptr_mem<boot_node>,
+                               boot_node>{});
+}
+
+template<class node>
+static void bench_lazy(std::string const& name) {
+  using mem     = vector_mem<node, std::vector<node>, std::uint32_t>;
+  using VecHeap = Heap<int, std::less<>, mem, node>;
+  auto const n    = bench_size() / 16;
+  auto const data = random_ints(n);
+  auto const tag  = ", n = " + std::to_string(n);
+
+  std::vector<node> block{};
+  BENCHMARK(name + ", cons everything, pop 10" + tag) {
+    block.clear();
+    auto x = into(VecHeap{{&block}}, data);
+    for(int i = 0; i < 10; ++i) x = x.pop();
+    return x.empty();
+  };
+
+  // after the first pop, which a lazy heap memoizes: the nodes it makes
+  // have to outlive the benchmark
+  block.clear();
+  auto const h = into(VecHeap{{&block}}, data);
+  (void)h.pop();
+  auto const live = block.size();
+  BENCHMARK(name + ", pop one version 100 more times" + tag) {
+    bool empty = false;
+    for(int i = 0; i < 100; ++i) empty |= h.pop().empty();
+    block.resize(live);
+    return empty;
+  };
+}
+
+TEST_CASE("eager vs lazy merges", "[lazy]") {
+  bench_lazy<Node<int, std::uint32_t>>("Node");
+  bench_lazy<PairingNode<int, std::uint32_t>>("PairingNode");
+  bench_lazy<LazyPairingNode<int, std::uint32_t>>("LazyPairingNode");
+}
+
+// Not a Catch benchmark: the tail is the point, so every operation is
+// timed on its own and the percentiles are printed.
+template<class H>
+static void latencies(std::string const& name, H h, std::size_t n) {
+  using clock     = std::chrono::steady_clock;
+  auto const data = random_ints(2 * n);
+  for(std::size_t i = 0; i < n; ++i) h.cons(data[i]);
+
+  std::vector<std::int64_t> ns;
+  ns.reserve(2 * n);
+  for(std::size_t i = n; i < 2 * n; ++i) {
+    for(bool const pop : {false, true}) {
+      auto const t0 = clock::now();
+      if(pop) h.pop();
+      else h.cons(data[i]);
+      auto const t1 = clock::now();
+      ns.push_back(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0)
+              .count());
+    }
+  }
+
+  std::vector<std::size_t> buckets(64);
+  for(auto const t : ns)
+    ++buckets[static_cast<std::size_t>(
+        std::bit_width(static_cast<std::uint64_t>(t)))];
+  std::sort(ns.begin(), ns.end());
+  auto const at = [&](double p) {
+    return ns[static_cast<std::size_t>(p * static_cast<double>(ns.size() - 1))];
+  };
+  std::printf("%s: p50 %lld ns, p99 %lld ns, p99.9 %lld ns, max %lld ns\n",
+              name.c_str(),
+              static_cast<long long>(at(0.5)),
+              static_cast<long long>(at(0.99)),
+              static_cast<long long>(at(0.999)),
+              static_cast<long long>(ns.back()));
+  if constexpr(requires { h.parts(); })
+    std::printf("  %zu parts left unmerged\n", h.parts());
+  for(std::size_t b = 0; b < buckets.size(); ++b)
+    if(buckets[b] > 0)
+      std::printf("  < %8llu ns: %zu\n", 1ull << b, buckets[b]);
+}
+
+// cons and pop in place, so plain heaps and ScheduledHeaps time the same
+template<class H>
+struct assigning {
+  H    h;
+  void cons(int x) { h = h.cons(x); }
+  void pop() { h = h.pop(); }
+};
+
+TEST_CASE("per-operation latency, eager vs scheduled", "[latency]") {
+  using node         = Node<int, std::uint32_t>;
+  using pairing_node = PairingNode<int, std::uint32_t>;
+  using mem          = vector_mem<node, std::vector<node>, std::uint32_t>;
+  using pairing_mem =
+      vector_mem<pairing_node, std::vector<pairing_node>, std::uint32_t>;
+  auto const n = bench_size() / 16;
+
+  // made big enough up front that no push_back reallocates mid-operation
+  std::vector<node>         block{};
+  std::vector<pairing_node> pairing_block{};
+  block.reserve(64 * n);
+  pairing_block.reserve(64 * n);
+
+  using NodeHeap    = Heap<int, std::less<>, mem, node>;
+  using PairingHeap = Heap<int, std::less<>, pairing_mem, pairing_node>;
+  latencies("Heap<Node>", assigning<NodeHeap>{NodeHeap{{&block}}}, n);
+  latencies("Heap<PairingNode>",
+            assigning<PairingHeap>{PairingHeap{{&pairing_block}}},
+            n);
+  for(std::size_t const budget : {16u, 64u}) {
+    block.clear();
+    latencies("ScheduledHeap<Node>, budget " + std::to_string(budget),
+              ScheduledHeap<int, std::less<>, mem, node>{budget, {&block}},
+              n);
+  }
+}
@@ -1,9 +1,31 @@
 #define CATCH_CONFIG_MAIN
 
 #include <leftist_heap/heap.hpp>
+#include <leftist_heap/arena.hpp>
+#include <leftist_heap/compact.hpp>
+#include <leftist_heap/slab.hpp>
+#include <leftist_heap/gc.hpp>
+#include <leftist_heap/nursery.hpp>
+#include <leftist_heap/mmap.hpp>
+#include <leftist_heap/shm.hpp>
+#include <leftist_heap/packed.hpp>
+#include <leftist_heap/soa.hpp>
+#include <leftist_heap/block.hpp>
+#include <leftist_heap/skew.hpp>
+#include <leftist_heap/pairing.hpp>
+#include <leftist_heap/bootstrap.hpp>
+#include <leftist_heap/lazy.hpp>
+#include <leftist_heap/schedule.hpp>
 
 #include <catch2/catch.hpp>
 
+#include <algorithm>
+#include <filesystem>
+#include <numeric>
+#include <random>
+#include <set>
+#include <stdexcept>
+
 using MyNode = Node<int, std::shared_ptr<void>>;
 using MyHeap = Heap<int, std::less<>, shared_ptr_mem<MyNode>, MyNode>;
 
@@ -48,3 +70,1001 @@ TEST_CASE("Vector heap can push"){
   auto h1 = h0.cons(3);
   REQUIRE(h1.peek()==3);
 }
+
+TEST_CASE("Nodes lay out their fields without padding") {
+  using node = Node<char, std::uint32_t>;
+  using mem  = vector_mem<node, std::vector<node>, std::uint32_t>;
+  STATIC_REQUIRE(sizeof(node) == 12);
+
+  std::vector<node> block{};
+  auto h = into(Heap<char, std::less<>, mem, node>{{&block}},
+                std::vector{'d', 'a', 'c', 'b'});
+  for(char expected : {'a', 'b', 'c', 'd'}) {
+    REQUIRE(h.peek() == expected);
+    h = h.pop();
+  }
+  REQUIRE(h.empty());
+}
+
+struct counts_copies {
+  int               v;
+  static inline int copies = 0;
+  counts_copies(int x) : v{x} {}
+  counts_copies(counts_copies const& other) : v{other.v} { ++copies; }
+  counts_copies(counts_copies&&)                 = default;
+  counts_copies& operator=(counts_copies const&) = default;
+  counts_copies& operator=(counts_copies&&)      = default;
+};
+
+TEST_CASE("Making a node moves its fields into place") {
+  using node = Node<counts_copies, std::size_t>;
+  std::vector<node> block{};
+  block.reserve(1);
+  vector_mem<node> mem{&block};
+  counts_copies::copies = 0;
+  auto const k = node::make1(mem, counts_copies{7});
+  REQUIRE(counts_copies::copies == 0);
+  REQUIRE(mem[k].elt().v == 7);
+
+  using packed = PackedNode<counts_copies, std::uint32_t>;
+  std::vector<packed> packed_block{};
+  packed_block.reserve(1);
+  rank_tagged_mem<vector_mem<packed, std::vector<packed>, std::uint32_t>>
+             packed_mem{{&packed_block}};
+  auto const p = packed::make1(packed_mem, counts_copies{8});
+  REQUIRE(counts_copies::copies == 0);
+  REQUIRE(packed_mem[p].elt().v == 8);
+}
+
+TEST_CASE("Size counts the elements of a heap") {
+  MyHeap h0{};
+  REQUIRE(h0.size() == 0);
+  REQUIRE(into(h0, std::vector<int>{5, 1, 2, 10, 3}).pop().size() == 4);
+}
+
+TEST_CASE("Weight-biased heap sorts and knows its size") {
+  using node       = WeightNode<int, std::uint32_t, std::uint32_t>;
+  using mem        = vector_mem<node, std::vector<node>, std::uint32_t>;
+  using WeightHeap = Heap<int, std::less<>, mem, node>;
+  STATIC_REQUIRE(NodeUtil<node>::is_counted_node<mem>);
+
+  std::mt19937                       gen{3};
+  std::uniform_int_distribution<int> dist{0, 999};
+  std::vector<int>                   data(300);
+  for(auto& x : data) x = dist(gen);
+
+  std::vector<node> block{};
+  auto h = into(WeightHeap{{&block}}, data);
+  REQUIRE(h.size() == data.size());
+
+  std::sort(data.begin(), data.end());
+  for(std::size_t i = 0; i < data.size(); ++i) {
+    REQUIRE(h.size() == data.size() - i);
+    // the heavier child is always on the left
+    auto const& n = block[h.root() - 1];
+    REQUIRE(NodeUtil<node>::count<std::size_t>(mem{&block}, n.right())
+            <= NodeUtil<node>::count<std::size_t>(mem{&block}, n.left()));
+    REQUIRE(h.peek() == data[i]);
+    h = h.pop();
+  }
+  REQUIRE(h.empty());
+}
+
+// Node::merge as it was, recursing down the right spines
+template<class node>
+static auto recursive_merge(auto mem, auto less, auto k1, auto k2) {
+  if(mem.is_null(k1)) return k2;
+  if(mem.is_null(k2)) return k1;
+  return less(mem[k2].elt(), mem[k1].elt())
+           ? node::make(mem,
+                        mem[k2].elt(),
+                        mem[k2].left(),
+                        recursive_merge<node>(mem, less, k1, mem[k2].right()))
+           : node::make(mem,
+                        mem[k1].elt(),
+                        mem[k1].left(),
+                        recursive_merge<node>(mem, less, k2, mem[k1].right()));
+}
+
+static bool same_tree(auto mem, auto k1, auto k2) {
+  if(mem.is_null(k1) || mem.is_null(k2))
+    return mem.is_null(k1) && mem.is_null(k2);
+  return mem[k1].elt() == mem[k2].elt()
+      && same_tree(mem, mem[k1].left(), mem[k2].left())
+      && same_tree(mem, mem[k1].right(), mem[k2].right());
+}
+
+TEST_CASE("Merge builds the same tree as the recursive merge") {
+  using node = Node<int, std::size_t>;
+  using mem  = vector_mem<node>;
+
+  std::mt19937                       gen{11};
+  std::uniform_int_distribution<int> dist{0, 20}; // plenty of ties
+  std::vector<node>                  block{};
+  mem const                          m{&block};
+  std::vector<std::size_t>           heaps{m.null()};
+  for(int i = 0; i < 400; ++i) {
+    auto const k1 = heaps[gen() % heaps.size()];
+    auto const k2 = i % 2 == 0 ? node::make1(m, dist(gen))
+                               : heaps[gen() % heaps.size()];
+    auto const merged = node::merge(m, std::less<>{}, k1, k2);
+    REQUIRE(same_tree(
+        m, merged, recursive_merge<node>(m, std::less<>{}, k1, k2)));
+    heaps.push_back(merged);
+  }
+}
+
+TEST_CASE("Building a heap from a range makes one node per element") {
+  using node    = Node<int, std::size_t>;
+  using VecHeap = Heap<int, std::less<>, vector_mem<node>, node>;
+
+  std::vector<int> data(1000);
+  std::iota(data.begin(), data.end(), 0);
+  std::shuffle(data.begin(), data.end(), std::mt19937{9});
+
+  std::vector<node> block{};
+  auto h = VecHeap::from_range({&block}, {}, data);
+  REQUIRE(block.size() == data.size());
+  REQUIRE(h.size() == data.size());
+  for(int expected = 0; expected < 1000; ++expected) {
+    REQUIRE(h.peek() == expected);
+    h = h.pop();
+  }
+  REQUIRE(h.empty());
+
+  REQUIRE(MyHeap::from_range({}, {}, std::vector<int>{}).empty());
+  REQUIRE(MyHeap::from_range({}, {}, std::vector{4, 2, 8}).peek() == 2);
+  // the end is a different type from the begin
+  auto const counted = std::views::iota(3) | std::views::take(10);
+  REQUIRE(MyHeap::from_range({}, {}, counted).size() == 10);
+  REQUIRE(MyHeap::from_range({}, {}, counted).peek() == 3);
+}
+
+TEST_CASE("Arena heap sorts") {
+  using node      = Node<int, void const*>;
+  using ArenaHeap = Heap<int, std::less<>, arena_mem<node, 4>, node>;
+
+  arena<node, 4> scratch;
+  auto h = into(ArenaHeap{{&scratch}}, std::vector<int>{5, 1, 4, 2, 3});
+  for(int i = 1; i <= 5; ++i, h = h.pop()) REQUIRE(h.peek() == i);
+  REQUIRE(h.empty());
+}
+
+TEST_CASE("Resetting an arena reuses its chunks") {
+  using node      = Node<std::string, void const*>;
+  using ArenaHeap = Heap<std::string, std::less<>, arena_mem<node>, node>;
+
+  arena<node> scratch;
+  for(int round = 0; round < 3; ++round) {
+    auto h = into(ArenaHeap{{&scratch}},
+                  std::vector<std::string>{"b", "c", "a"});
+    REQUIRE(h.peek() == "a");
+    REQUIRE(scratch.size() > 0);
+    scratch.reset();
+    REQUIRE(scratch.size() == 0);
+  }
+}
+
+TEST_CASE("Releasing an arena mark rolls back speculative edits") {
+  using node      = Node<int, void const*>;
+  using ArenaHeap = Heap<int, std::less<>, arena_mem<node, 4>, node>;
+
+  arena<node, 4>     scratch;
+  arena_mem<node, 4> mem{&scratch};
+  auto const         h    = into(ArenaHeap{mem}, std::vector<int>{3, 1, 2});
+  auto const         used = scratch.size();
+  auto const         m    = mem.mark();
+  for(int i = 0; i < 10; ++i) {
+    auto const attempt = h.cons(-i).cons(7).pop();
+    REQUIRE(attempt.peek() == 1);
+    mem.release(m);
+    REQUIRE(scratch.size() == used);
+  }
+  REQUIRE(h.pop().peek() == 2);
+}
+
+// the nodes of the heap at k
+template<class Mem>
+static void collect_nodes(Mem                      mem,
+                          typename Mem::Key const& k,
+                          std::set<void const*>&   out) {
+  if(mem.is_null(k)) return;
+  out.insert(&mem[k]);
+  collect_nodes(mem, mem[k].left(), out);
+  collect_nodes(mem, mem[k].right(), out);
+}
+
+// the nodes a.merge(b) made, which should be stride bytes apart
+template<class H>
+static std::set<void const*> merged_nodes(H const& a, H const& b) {
+  std::set<void const*> old, all;
+  collect_nodes(a.mem(), a.root(), old);
+  collect_nodes(b.mem(), b.root(), old);
+  collect_nodes(a.mem(), a.merge(b).root(), all);
+  std::set<void const*> made;
+  std::ranges::set_difference(all, old, std::inserter(made, made.end()));
+  return made;
+}
+
+static std::size_t span_of(std::set<void const*> const& nodes) {
+  return reinterpret_cast<std::uintptr_t>(*nodes.rbegin())
+       - reinterpret_cast<std::uintptr_t>(*nodes.begin());
+}
+
+TEST_CASE("Merged spines are made contiguously") {
+  std::vector<int> odds, evens;
+  for(int i = 0; i < 16; ++i) (i % 2 == 0 ? evens : odds).push_back(i);
+
+  SECTION("arena: merge skips to the next chunk if its spine won't fit") {
+    using node      = Node<int, void const*>;
+    using ArenaHeap = Heap<int, std::less<>, arena_mem<node, 8>, node>;
+    arena<node, 8>     scratch;
+    arena_mem<node, 8> mem{&scratch};
+    auto const         a = into(ArenaHeap{mem}, odds);
+    auto const         b = into(ArenaHeap{mem}, evens);
+
+    // how many nodes the merge makes, then as many slots short of that
+    auto const m    = mem.mark();
+    auto const made = merged_nodes(a, b).size();
+    mem.release(m);
+    REQUIRE(made >= 2);
+    while((scratch.size() + made - 1) % 8 != 0) ArenaHeap{mem}.cons(0);
+
+    auto const before = scratch.size();
+    auto const nodes  = merged_nodes(a, b);
+    REQUIRE(nodes.size() == made);
+    REQUIRE(span_of(nodes) == (made - 1) * sizeof(node));
+    REQUIRE(scratch.size() - before == 8 - (before % 8) + made);
+  }
+  SECTION("shared_ptr: merge carves its spine out of one run") {
+    auto const a     = into(MyHeap{}, odds);
+    auto const b     = into(MyHeap{}, evens);
+    auto const nodes = merged_nodes(a, b);
+    REQUIRE(nodes.size() >= 2);
+    // malloc'd one by one they'd be at least a header further apart
+    REQUIRE(span_of(nodes)
+            == (nodes.size() - 1) * shared_node_size<MyNode>());
+  }
+  SECTION("shared_ptr: runs are freed with their last node") {
+    std::vector<int> data(200);
+    std::iota(data.begin(), data.end(), 0);
+    std::shuffle(data.begin(), data.end(), std::mt19937{5});
+    std::vector<MyHeap> versions{into(MyHeap{}, data)};
+    for(int i = 0; i < 100; ++i)
+      versions.push_back(versions.back().pop().cons(i));
+    std::vector<int> popped;
+    for(auto h = versions[50]; !h.empty(); h = h.pop())
+      popped.push_back(h.peek());
+    REQUIRE(std::is_sorted(popped.begin(), popped.end()));
+    REQUIRE(popped.size() == 200);
+  }
+}
+
+TEST_CASE("A shared_ptr run is cleaned up however it ends") {
+  SECTION("a node that didn't fit in the run can outlive it") {
+    auto const run = node_run::make(shared_node_size<int>());
+    auto       in  = std::allocate_shared<int>(run_allocator<int>{run}, 1);
+    auto const out = std::allocate_shared<int>(run_allocator<int>{run}, 2);
+    run->drop();
+    in.reset();
+    REQUIRE(*out == 2);
+  }
+  shared_ptr_mem<int> mem;
+  auto const&         cache = run_cache<int>::local();
+  SECTION("a run ends with its scope, even if making a node threw") {
+    try {
+      auto const reserved = mem.reserve(8);
+      mem.make_key(1);
+      REQUIRE(cache.active());
+      throw std::runtime_error{"make_key"};
+    } catch(std::runtime_error const&) {}
+    REQUIRE(!cache.active());
+    REQUIRE(!run_cache<long>::local().active());
+  }
+  SECTION("a long spine only puts its first max_run nodes in the run") {
+    auto const reserved = mem.reserve(1000);
+    std::vector<std::shared_ptr<void>> keys;
+    for(std::size_t i = 0; i < run_cache<int>::max_run; ++i)
+      keys.push_back(mem.make_key(0));
+    REQUIRE(!cache.active());
+  }
+}
+
+TEST_CASE("Compacting a vector heap keeps only live nodes") {
+  using node    = Node<int, size_t>;
+  using VecHeap = Heap<int, std::less<>, vector_mem<node>, node>;
+
+  std::vector<node> block{};
+  auto h = into(VecHeap{{&block}}, std::vector<int>{8, 3, 6, 1, 9, 2, 7});
+  auto const pushed = h.cons(0);
+  h                 = h.pop().pop();
+
+  std::vector<node> fresh{};
+  std::array const  roots{h, pushed};
+  auto const        live = compact(roots, &fresh);
+  REQUIRE(fresh.size() < block.size());
+
+  for(auto const& [old_heap, new_heap] :
+      {std::pair{roots[0], live[0]}, std::pair{roots[1], live[1]}}) {
+    auto a = old_heap;
+    auto b = new_heap;
+    for(; !a.empty(); a = a.pop(), b = b.pop()) {
+      REQUIRE(!b.empty());
+      REQUIRE(a.peek() == b.peek());
+    }
+    REQUIRE(b.empty());
+  }
+
+  // left spines are laid out contiguously
+  auto const vmem = live[0].mem();
+  for(auto k = live[0].root(); !vmem.is_null(vmem[k].left());
+      k      = vmem[k].left())
+    REQUIRE(vmem[k].left() == k + 1);
+}
+
+TEST_CASE("Relaying out a vector heap along its right spine") {
+  using node    = Node<int, size_t>;
+  using VecHeap = Heap<int, std::less<>, vector_mem<node>, node>;
+
+  std::vector<node> block{};
+  auto const h = into(VecHeap{{&block}}, std::vector<int>{4, 9, 1, 7, 3});
+
+  for(auto const order :
+      {layout::left_spine, layout::right_spine, layout::breadth_first}) {
+    std::vector<node> fresh{};
+    auto const        moved = compact(std::array{h}, &fresh, order)[0];
+    auto const        vmem  = moved.mem();
+
+    if(order == layout::right_spine)
+      for(auto k = moved.root(); !vmem.is_null(vmem[k].right());
+          k      = vmem[k].right())
+        REQUIRE(vmem[k].right() == k + 1);
+    if(order == layout::breadth_first) REQUIRE(moved.root() == 1);
+
+    auto a = h;
+    auto b = moved;
+    for(; !a.empty(); a = a.pop(), b = b.pop()) REQUIRE(a.peek() == b.peek());
+    REQUIRE(b.empty());
+  }
+}
+
+struct slab_tag;
+using SlabNode = Node<int, slab_key<slab_tag>>;
+struct slab_tag {
+  using type = SlabNode;
+};
+using SlabHeap = Heap<int, std::less<>, slab_mem<SlabNode>, SlabNode>;
+
+TEST_CASE("Slab heap sorts") {
+  STATIC_REQUIRE(sizeof(SlabNode) == 16);
+  auto h = into(SlabHeap{}, std::vector<int>{5, 1, 4, 2, 3});
+  for(int i = 1; i <= 5; ++i, h = h.pop()) REQUIRE(h.peek() == i);
+  REQUIRE(h.empty());
+}
+
+TEST_CASE("Slab heap recycles dead nodes") {
+  auto& slab = slab_key<slab_tag>::slab();
+  {
+    auto const h = into(SlabHeap{}, std::vector<int>(1000, 7));
+    REQUIRE(h.peek() == 7);
+  }
+  auto const used = slab.high_water();
+  {
+    auto const h = into(SlabHeap{}, std::vector<int>(1000, 7));
+    REQUIRE(h.pop().peek() == 7);
+  }
+  REQUIRE(slab.high_water() == used);
+}
+
+TEST_CASE("Atomic slab heap keeps old versions alive") {
+  struct tag;
+  using node = Node<int, slab_key<tag, std::uint64_t, refcount::atomic>>;
+  struct tag {
+    using type = node;
+  };
+  using AtomicHeap = Heap<int, std::less<>, slab_mem<node>, node>;
+
+  auto const h1 = into(AtomicHeap{}, std::vector<int>{2, 3});
+  auto const h2 = h1.cons(1);
+  REQUIRE(h1.pop().peek() == 3);
+  REQUIRE(h2.peek() == 1);
+}
+
+TEST_CASE("Building a heap on several threads") {
+  struct tag;
+  using node = Node<int, slab_key<tag, std::uint32_t, refcount::atomic>>;
+  struct tag {
+    using type = node;
+  };
+  using AtomicHeap = Heap<int, std::less<>, slab_mem<node>, node>;
+  STATIC_REQUIRE(!thread_safe_mem<slab_mem<SlabNode>>);
+
+  std::vector<int> data(5000);
+  std::iota(data.begin(), data.end(), 0);
+  std::shuffle(data.begin(), data.end(), std::mt19937{13});
+
+  auto       h1 = MyHeap::from_range({}, {}, data, 4);
+  auto       h2 = AtomicHeap::from_range({}, {}, data, 3);
+  auto const h3 = MyHeap::from_range({}, {}, std::vector{2, 1}, 8);
+  for(int expected = 0; expected < 5000; ++expected) {
+    REQUIRE(h1.peek() == expected);
+    REQUIRE(h2.peek() == expected);
+    h1 = h1.pop();
+    h2 = h2.pop();
+  }
+  REQUIRE(h1.empty());
+  REQUIRE(h3.peek() == 1);
+  REQUIRE(MyHeap::from_range({}, {}, std::vector<int>{}, 4).empty());
+
+  // an arena per thread: nothing's shared while building
+  using arena_node = Node<int, void const*>;
+  using ArenaHeap =
+      Heap<int, std::less<>, arena_mem<arena_node>, arena_node>;
+  std::vector<arena<arena_node>>     arenas(3);
+  std::vector<arena_mem<arena_node>> mems;
+  for(auto& a : arenas) mems.push_back({&a});
+  auto h4 = ArenaHeap::from_range_in(mems, {}, data);
+  // each made its third, the first also the merges
+  for(auto const& a : arenas) REQUIRE(a.size() >= data.size() / 3);
+  for(int expected = 0; expected < 5000; ++expected, h4 = h4.pop())
+    REQUIRE(h4.peek() == expected);
+  REQUIRE(h4.empty());
+  REQUIRE(ArenaHeap::from_range_in(mems, {}, std::vector{2, 1}).peek() == 1);
+}
+
+TEST_CASE("Transient heaps overwrite the nodes nobody else sees") {
+  using node    = Node<int, size_t>;
+  using VecHeap = Heap<int, std::less<>, vector_mem<node>, node>;
+
+  std::vector<int> data(500);
+  std::iota(data.begin(), data.end(), 0);
+  std::shuffle(data.begin(), data.end(), std::mt19937{5});
+
+  std::vector<node> persistent_block{}, transient_block{};
+  auto const        h = into(VecHeap{{&persistent_block}}, data);
+  auto t = VecHeap{{&transient_block}}.transient();
+  for(auto const x : data) t.cons(x);
+  // a cons only makes the new node, the spine is edited in place
+  REQUIRE(transient_block.size() == data.size());
+  REQUIRE(persistent_block.size() > 2 * data.size());
+
+  auto const made = transient_block.size();
+  for(int expected = 0; expected < 100; ++expected, t.pop())
+    REQUIRE(t.peek() == expected);
+  REQUIRE(transient_block.size() == made);
+
+  // nodes from before the transient are copied
+  auto const before = persistent_block.size();
+  auto       u      = h.transient();
+  u.pop().pop();
+  REQUIRE(persistent_block.size() > before);
+  auto const h2 = std::move(u).persistent();
+  REQUIRE(h2.peek() == 2);
+  REQUIRE(h.peek() == 0);
+  REQUIRE(h.size() == data.size());
+  REQUIRE(std::move(t).persistent().size() == data.size() - 100);
+}
+
+TEST_CASE("Transient heaps move but don't copy") {
+  using node      = Node<int, size_t>;
+  using VecHeap   = Heap<int, std::less<>, vector_mem<node>, node>;
+  using Transient = decltype(VecHeap{}.transient());
+  // two copies would both overwrite the nodes made since their epoch
+  STATIC_REQUIRE(!std::is_copy_constructible_v<Transient>);
+  STATIC_REQUIRE(!std::is_copy_assignable_v<Transient>);
+  STATIC_REQUIRE(std::is_nothrow_move_constructible_v<Transient>);
+
+  std::vector<node> block{};
+  auto              t = VecHeap{{&block}}.transient();
+  for(int const x : {5, 1, 4, 2, 3}) t.cons(x);
+  auto t2 = std::move(t);
+  t2.pop().pop();
+  REQUIRE(t2.size() == 3);
+  REQUIRE(std::move(t2).persistent().peek() == 3);
+}
+
+TEST_CASE("Transients of shared heaps leave the original alone") {
+  auto const h = into(MyHeap{}, std::vector<int>{5, 1, 4, 2, 3});
+  auto       t = h.transient();
+  t.cons(0).pop().pop().cons(7);
+  auto h2 = std::move(t).persistent();
+  for(auto const expected : {2, 3, 4, 5, 7}) {
+    REQUIRE(h2.peek() == expected);
+    h2 = h2.pop();
+  }
+  REQUIRE(h2.empty());
+  REQUIRE(h.size() == 5);
+  REQUIRE(h.peek() == 1);
+
+  // nobody else has h3's nodes, so the root is edited, not copied
+  auto       h3   = into(MyHeap{}, std::vector<int>{1, 2, 3});
+  auto const root = h3.root().get();
+  auto       t3   = std::move(h3).transient();
+  t3.cons(9);
+  auto const h4 = std::move(t3).persistent();
+  REQUIRE(h4.root().get() == root);
+  REQUIRE(h4.size() == 4);
+}
+
+static void node_addresses(shared_ptr_mem<MyNode>   mem,
+                           std::shared_ptr<void> const& k,
+                           std::vector<void const*>&    out) {
+  if(mem.is_null(k)) return;
+  out.push_back(k.get());
+  node_addresses(mem, mem[k].left(), out);
+  node_addresses(mem, mem[k].right(), out);
+}
+
+TEST_CASE("Popping an rvalue heap reuses the nodes only it holds") {
+  std::vector<int> data(100);
+  std::iota(data.begin(), data.end(), 0);
+  std::shuffle(data.begin(), data.end(), std::mt19937{7});
+  auto const addresses = [](MyHeap const& h) {
+    std::vector<void const*> out;
+    node_addresses(h.mem(), h.root(), out);
+    std::sort(out.begin(), out.end());
+    return out;
+  };
+
+  auto       h      = into(MyHeap{}, data);
+  auto const before = addresses(h);
+  h                 = std::move(h).pop();
+  h                 = std::move(h).pop();
+  auto const after  = addresses(h);
+  REQUIRE(after.size() == 98);
+  REQUIRE(std::includes(
+      before.begin(), before.end(), after.begin(), after.end()));
+
+  // a shared version is copied, as by pop() const&
+  auto const copy = h;
+  auto const h2   = std::move(h).pop();
+  REQUIRE(copy.peek() == 2);
+  REQUIRE(copy.size() == 98);
+  REQUIRE(h2.peek() == 3);
+  REQUIRE(addresses(copy) == after);
+
+  auto const h3 = MyHeap{copy}.cons(-1);
+  REQUIRE(h3.peek() == -1);
+  REQUIRE(copy.peek() == 2);
+}
+
+TEST_CASE("Collecting a gc heap frees only unreachable nodes") {
+  using node   = Node<int, std::uint32_t>;
+  using GcHeap = Heap<int, std::less<>, gc_mem<node>, node>;
+
+  gc_space<node> space;
+  gc_mem<node>   mem{&space};
+
+  auto h = into(GcHeap{mem}, std::vector<int>{6, 2, 9, 4, 1});
+  REQUIRE(mem.collect() > 0);
+  auto const live = space.live();
+
+  std::optional<GcHeap> old{h};
+  h = h.pop().pop();
+  REQUIRE(mem.collect() == 0); // old still holds everything
+  old.reset();
+  REQUIRE(mem.collect() > 0);
+
+  // freed slots are reused before the space grows
+  auto const capacity = space.capacity();
+  h                   = h.cons(3).cons(5);
+  REQUIRE(space.capacity() == capacity);
+  REQUIRE(space.live() <= live + 4);
+
+  for(int expected : {3, 4, 5, 6, 9}) {
+    REQUIRE(h.peek() == expected);
+    h = h.pop();
+    mem.collect();
+  }
+  REQUIRE(h.empty());
+}
+
+TEST_CASE("Minor collections promote only live nursery nodes") {
+  using node        = Node<int, std::uint32_t>;
+  using NurseryHeap = Heap<int, std::less<>, nursery_mem<node>, node>;
+
+  nursery_space<node> space;
+  nursery_mem<node>   mem{&space};
+
+  auto       h     = into(NurseryHeap{mem}, std::vector<int>{6, 2, 9, 4, 1});
+  auto const older = h;
+  h                = h.pop().cons(3);
+  auto const made  = space.nursery_size();
+  auto const moved = space.minor_collect();
+  REQUIRE(moved < made);
+  REQUIRE(space.nursery_size() == 0);
+  REQUIRE(space.stats().promotion_rate() < 1.0);
+
+  REQUIRE(older.peek() == 1);
+  h = h.cons(0).pop();
+  space.minor_collect();
+  for(int expected : {2, 3, 4, 6, 9}) {
+    REQUIRE(h.peek() == expected);
+    h = h.pop();
+  }
+  REQUIRE(h.empty());
+  REQUIRE(space.stats().collections == 2);
+
+  REQUIRE(space.major_collect() > 0);
+  auto rest = older;
+  for(int expected : {1, 2, 4, 6, 9}) {
+    REQUIRE(rest.peek() == expected);
+    rest = rest.pop();
+  }
+}
+
+TEST_CASE("A file-backed heap survives reopening its file") {
+  using node     = Node<int, std::uint64_t>;
+  using FileHeap = Heap<int, std::less<>, mmap_mem<node>, node>;
+
+  auto const path =
+      std::filesystem::temp_directory_path() / "leftist_heap_test.heap";
+  std::filesystem::remove(path);
+  {
+    mapped_file<node> file{path.c_str(), 2}; // small, so it has to grow
+    auto h = into(FileHeap{{&file}}, std::vector<int>{5, 1, 4, 2, 3});
+    file.set_root(h.root());
+    file.checkpoint();
+    REQUIRE(file.capacity() >= file.size());
+  }
+  {
+    mapped_file<node> file{path.c_str()};
+    auto h = FileHeap::adopt({&file}, file.root());
+    for(int i = 1; i <= 5; ++i, h = h.pop()) REQUIRE(h.peek() == i);
+    REQUIRE(h.empty());
+  }
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Readers of a shared segment pop their own versions") {
+  using node      = Node<int, std::uint64_t>;
+  using ShmHeap   = Heap<int, std::less<>, shm_mem<node>, node>;
+  auto const name = "/leftist_heap_test_" + std::to_string(::getpid());
+
+  auto writer = shared_segment<node>::create(name.c_str(), 64, 8);
+  auto reader = shared_segment<node>::attach(name.c_str());
+  shared_segment<node>::remove(name.c_str());
+
+  auto const h = into(ShmHeap{{&writer}}, std::vector<int>{5, 1, 4, 2, 3});
+  writer.publish(h.root());
+
+  auto mine = ShmHeap::adopt({&reader}, reader.published());
+  mine      = mine.cons(0).pop().pop();
+  REQUIRE(mine.peek() == 2);
+
+  // the writer's version is untouched
+  auto theirs = h;
+  for(int i = 1; i <= 5; ++i, theirs = theirs.pop())
+    REQUIRE(theirs.peek() == i);
+}
+
+TEST_CASE("A shared segment that can't be made leaves its name free") {
+  using node      = Node<int, std::uint64_t>;
+  auto const name = "/leftist_heap_test_" + std::to_string(::getpid());
+  // far more than can be mapped
+  REQUIRE_THROWS(shared_segment<node>::create(
+      name.c_str(), std::size_t{1} << 58, std::size_t{1} << 20));
+  auto const seg = shared_segment<node>::create(name.c_str(), 64, 8);
+  shared_segment<node>::remove(name.c_str());
+}
+
+TEST_CASE("Packing ranks into keys shrinks nodes") {
+  // int64_t elements: an int would take the padding Node's rank uses
+  STATIC_REQUIRE(sizeof(PackedNode<std::int64_t, std::uint64_t>)
+                 < sizeof(Node<std::int64_t, std::uint64_t>));
+  STATIC_REQUIRE(sizeof(PackedNode<int, std::uint32_t>) == 12);
+  STATIC_REQUIRE(sizeof(Node<int, std::uint32_t>) == 16);
+
+  using node       = PackedNode<int, std::uint32_t>;
+  using mem        = rank_tagged_mem<vector_mem<node, std::vector<node>,
+                                         std::uint32_t>>;
+  using PackedHeap = Heap<int, std::less<>, mem, node>;
+
+  std::vector<node> block{};
+  auto h = into(PackedHeap{{{&block}}}, std::vector<int>{7, 3, 9, 1, 5, 2});
+  REQUIRE(h.root() >> 27 != 0); // the root key carries its rank
+  for(int expected : {1, 2, 3, 5, 7, 9}) {
+    REQUIRE(h.peek() == expected);
+    h = h.pop();
+  }
+  REQUIRE(h.empty());
+}
+
+TEST_CASE("SOA heap sorts") {
+  using node    = SoaNode<double>;
+  using SoaHeap = Heap<double, std::less<>, soa_mem<double>, node>;
+
+  soa_block<double> block{};
+  auto h = into(SoaHeap{{&block}}, std::vector{2.5, 0.5, 3.5, 1.5});
+  REQUIRE(block.lefts.size() == block.elts.size());
+  for(double expected : {0.5, 1.5, 2.5, 3.5}) {
+    REQUIRE(h.peek() == expected);
+    h = h.pop();
+  }
+  REQUIRE(h.empty());
+}
+
+struct throws_on_move {
+  int                v;
+  static inline bool armed = false;
+  throws_on_move(int x) : v{x} {}
+  throws_on_move(throws_on_move const&) = default;
+  throws_on_move(throws_on_move&& other) : v{other.v} {
+    if(armed) throw std::runtime_error{"move"};
+  }
+  throws_on_move& operator=(throws_on_move const&) = default;
+};
+
+TEST_CASE("A throwing SOA make_key leaves the arrays in step") {
+  soa_block<throws_on_move> block{};
+  soa_mem<throws_on_move>   mem{&block};
+  for(int i = 0; i < 16; ++i) mem.make_key(i, 0, 0, 1);
+  throws_on_move::armed = true;
+  REQUIRE_THROWS(mem.make_key(throws_on_move{16}, 0, 0, 1));
+  throws_on_move::armed = false;
+  REQUIRE(block.elts.size() == 16);
+  REQUIRE(block.lefts.size() == 16);
+  REQUIRE(block.rights.size() == 16);
+  REQUIRE(block.ranks.size() == 16);
+  REQUIRE(mem.make_key(17, 0, 0, 1) == 17);
+}
+
+TEST_CASE("Block heap sorts, mostly popping within blocks") {
+  using node      = BlockNode<int, std::uint32_t, 8>;
+  using mem       = vector_mem<node, std::vector<node>, std::uint32_t>;
+  using BlockHeap = Heap<int, std::less<>, mem, node>;
+
+  std::mt19937                       gen{7};
+  std::uniform_int_distribution<int> dist{0, 99};
+  std::vector<int>                   data(500);
+  for(auto& x : data) x = dist(gen);
+
+  std::vector<node> block{};
+  auto const        h = into(BlockHeap{{&block}}, data);
+  REQUIRE(h.size() == data.size());
+
+  // interleave conses and pops so merges see blocks at every offset
+  auto             x = h;
+  std::vector<int> popped;
+  for(int i = 0; i < 300; ++i) {
+    popped.push_back(x.peek());
+    x = x.pop();
+    if(i % 3 == 0) x = x.cons(dist(gen) + 100);
+  }
+  REQUIRE(std::is_sorted(popped.begin(), popped.end()));
+
+  // the first version is untouched
+  std::sort(data.begin(), data.end());
+  auto        y    = h;
+  std::size_t free = 0;
+  for(auto const expected : data) {
+    REQUIRE(y.peek() == expected);
+    auto const before = block.size();
+    y                 = y.pop();
+    free += block.size() == before;
+  }
+  REQUIRE(y.empty());
+  // most pops just move along a block
+  REQUIRE(free > data.size() / 2);
+}
+
+// 0, 1, ..., n - 1 in a random order
+static std::vector<int> shuffled(int n, unsigned seed) {
+  std::vector<int> v(static_cast<std::size_t>(n));
+  std::iota(v.begin(), v.end(), 0);
+  std::shuffle(v.begin(), v.end(), std::mt19937{seed});
+  return v;
+}
+
+// h pops first, first + 1, ..., last - 1 and is then empty
+template<class H>
+static void drains_in_order(H h, int first, int last) {
+  for(int expected = first; expected < last; ++expected, h = h.pop())
+    REQUIRE(h.peek() == expected);
+  REQUIRE(h.empty());
+}
+
+template<class node>
+using ptr_heap = Heap<int, std::less<>, shared_ptr_mem<node>, node>;
+
+TEST_CASE("Skew heap sorts, even along long right spines") {
+  using node     = SkewNode<int, std::uint32_t>;
+  using mem_t    = vector_mem<node, std::vector<node>, std::uint32_t>;
+  using SkewHeap = Heap<int, std::less<>, mem_t, node>;
+  STATIC_REQUIRE(sizeof(node) < sizeof(Node<int, std::uint32_t>));
+
+  auto const        data = shuffled(500, 3);
+  std::vector<node> block{};
+  auto const        h = into(SkewHeap{{&block}}, data);
+  drains_in_order(h, 0, 500);
+  REQUIRE(h.size() == 500);
+
+  // two right spines of 300, too long for merge's path array
+  mem_t         mem{&block};
+  std::uint32_t evens = mem.null(), odds = mem.null();
+  for(int i = 299; i >= 0; --i) {
+    evens = node::make(mem, 2 * i, mem.null(), evens);
+    odds  = node::make(mem, 2 * i + 1, mem.null(), odds);
+  }
+  drains_in_order(
+      SkewHeap::adopt(mem, node::merge(mem, std::less<>{}, evens, odds)),
+      0,
+      600);
+
+  using ptr_node = SkewNode<int, std::shared_ptr<void>>;
+  drains_in_order(into(ptr_heap<ptr_node>{}, data), 0, 500);
+}
+
+TEST_CASE("Pairing heap sorts and keeps old versions") {
+  using node        = PairingNode<int, std::uint32_t>;
+  using mem_t       = vector_mem<node, std::vector<node>, std::uint32_t>;
+  using PairingHeap = Heap<int, std::less<>, mem_t, node>;
+
+  auto const        data = shuffled(500, 11);
+  std::vector<node> block{};
+  auto const        h = into(PairingHeap{{&block}}, data);
+  REQUIRE(h.size() == 500);
+  auto x = h;
+  for(int expected = 0; expected < 250; ++expected, x = x.pop())
+    REQUIRE(x.peek() == expected);
+  auto const y = x.cons(-1);
+  REQUIRE(y.peek() == -1);
+  REQUIRE(y.size() == 251);
+  drains_in_order(x, 250, 500);
+  REQUIRE(h.peek() == 0);
+
+  auto const z = PairingHeap::from_range({&block}, {}, data);
+  REQUIRE(z.size() == 500);
+  drains_in_order(z, 0, 500);
+
+  using ptr_node = PairingNode<int, std::shared_ptr<void>>;
+  drains_in_order(into(ptr_heap<ptr_node>{}, data), 0, 500);
+}
+
+// Conses alone, rising and falling, which make chains of nodes a million
+// long (pairing heaps' siblings or first children, say): dropping those
+// recursively would blow the stack.
+template<class node>
+static void drop_cons_only_heaps() {
+  for(int const sign : {1, -1}) {
+    ptr_heap<node> h;
+    for(int i = 0; i < 1'000'000; ++i) h = h.cons(sign * i);
+    REQUIRE(h.peek() == (sign == 1 ? 0 : -999'999));
+  }
+}
+
+TEST_CASE("Dropping a big pairing heap doesn't recurse") {
+  drop_cons_only_heaps<PairingNode<int, std::shared_ptr<void>>>();
+}
+
+TEST_CASE("Bootstrapped heaps merge without walking spines") {
+  using elt      = boot_elt<int, std::uint32_t>;
+  using node     = PairingNode<elt, std::uint32_t>;
+  using mem_t    = vector_mem<node, std::vector<node>, std::uint32_t>;
+  using BootHeap = BootstrappedHeap<int, std::less<>, mem_t, node>;
+
+  auto const data = shuffled(400, 17);
+
+  // 20 queues of 20, merged into one
+  std::vector<node>     block{};
+  std::vector<BootHeap> queues(20, BootHeap{{&block}});
+  for(std::size_t i = 0; i < data.size(); ++i)
+    queues[i % 20] = queues[i % 20].cons(data[i]);
+  auto all = BootHeap{{&block}};
+  for(auto const& q : queues) {
+    auto const before = block.size();
+    all               = all.merge(q);
+    // a merge is one inner cons: a new node, and a link of two
+    REQUIRE(block.size() - before <= 3);
+  }
+  REQUIRE(all.size() == 400);
+  REQUIRE(queues[3].size() == 20);
+
+  drains_in_order(all, 0, 400);
+  REQUIRE(all.peek() == 0);
+  REQUIRE(all.merge(BootHeap{{&block}}).size() == 400);
+
+  using ptr_node = PairingNode<boot_elt<int, std::shared_ptr<void>>,
+                               std::shared_ptr<void>>;
+  drains_in_order(into(BootstrappedHeap<int,
+                                        std::less<>,
+                                        shared_ptr_mem<ptr_node>,
+                                        ptr_node>{},
+                       data),
+                  0,
+                  400);
+}
+
+TEST_CASE("Lazy pairing heaps force each suspension once") {
+  using node     = LazyPairingNode<int, std::uint32_t>;
+  using mem_t    = vector_mem<node, std::vector<node>, std::uint32_t>;
+  using LazyHeap = Heap<int, std::less<>, mem_t, node>;
+
+  auto const        data = shuffled(500, 19);
+  std::vector<node> block{};
+  auto const        h = into(LazyHeap{{&block}}, data);
+  // cons only links
+  REQUIRE(block.size() <= 2 * data.size());
+  REQUIRE(h.size() == 500);
+
+  // the second pop of a version finds its work done
+  auto const before = block.size();
+  auto const first  = h.pop();
+  auto const forced = block.size() - before;
+  auto const second = h.pop();
+  REQUIRE(block.size() - before - forced < forced);
+  REQUIRE(first.peek() == 1);
+  REQUIRE(second.peek() == 1);
+  drains_in_order(second, 1, 500);
+  REQUIRE(first.size() == 499);
+
+  auto const y = LazyHeap::from_range({&block}, {}, data).cons(-1);
+  drains_in_order(y, -1, 500);
+
+  using ptr_node = LazyPairingNode<int, std::shared_ptr<void>>;
+  drains_in_order(into(ptr_heap<ptr_node>{}, data), 0, 500);
+}
+
+TEST_CASE("Dropping a big lazy pairing heap doesn't recurse") {
+  drop_cons_only_heaps<LazyPairingNode<int, std::shared_ptr<void>>>();
+}
+
+TEST_CASE("Scheduled heaps bound the merging each operation does") {
+  using node  = Node<int, std::uint32_t>;
+  using mem_t = vector_mem<node, std::vector<node>, std::uint32_t>;
+  using Sched = ScheduledHeap<int, std::less<>, mem_t, node>;
+
+  std::mt19937                       gen{23};
+  std::uniform_int_distribution<int> dist{0, 999};
+  std::vector<node>                  block{};
+  std::multiset<int>                 model;
+
+  for(std::size_t const budget : {0u, 1u, 4u, 64u}) {
+    Sched h{budget, {&block}};
+    for(int i = 0; i < 2000; ++i) {
+      if(model.empty() || dist(gen) % 3 != 0) {
+        auto const x      = dist(gen);
+        auto const before = block.size();
+        h.cons(x);
+        model.insert(x);
+        // the new node, and at most a node per step
+        REQUIRE(block.size() - before <= 1 + budget);
+      } else {
+        auto const before = block.size();
+        REQUIRE(h.peek() == *model.begin());
+        h.pop();
+        model.erase(model.begin());
+        REQUIRE(block.size() - before <= budget);
+      }
+      REQUIRE(h.empty() == model.empty());
+      if(!model.empty()) REQUIRE(h.peek() == *model.begin());
+    }
+    REQUIRE(h.size() == model.size());
+    if(budget == 0) REQUIRE(h.parts() > 100);
+    if(budget == 64) REQUIRE(h.parts() < 4);
+
+    auto whole = h.persistent();
+    for(auto const x : model) {
+      REQUIRE(whole.peek() == x);
+      whole = whole.pop();
+    }
+    REQUIRE(whole.empty());
+    while(!h.empty()) h.pop();
+    model.clear();
+  }
+
+  // only nodes whose right child is a subtree with a short spine
+  STATIC_REQUIRE(is_leftist_node<WeightNode<int, std::uint32_t>>);
+  STATIC_REQUIRE(!is_leftist_node<SkewNode<int, std::uint32_t>>);
+  STATIC_REQUIRE(!is_leftist_node<PairingNode<int, std::uint32_t>>);
+
+  using packed = PackedNode<int, std::uint32_t>;
+  using packed_mem =
+      rank_tagged_mem<vector_mem<packed, std::vector<packed>, std::uint32_t>>;
+  std::vector<packed> packed_block{};
+  ScheduledHeap<int, std::less<>, packed_mem, packed> p{4, {{&packed_block}}};
+  for(int const x : {5, 1, 4, 2, 3}) p.cons(x);
+  for(int expected = 1; expected <= 5; ++expected, p.pop())
+    REQUIRE(p.peek() == expected);
+  REQUIRE(p.empty());
+}